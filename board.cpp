@@ -5,6 +5,113 @@
 
 namespace board {
 
+namespace {
+
+// Orthogonal directions first, then diagonal.
+constexpr int kDirections[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+constexpr int kKnightJumps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+
+// ASCII piece letters: lower case is Black, and setting bit 5 lowers it.
+bool isWhitePiece(char piece) { return piece < 'a'; }
+char pieceType(char piece) { return static_cast<char>(piece | 0x20); }
+
+bool slidesAlong(char piece, int direction) {
+  const char p = pieceType(piece);
+  return p == 'q' || (direction < 4 ? p == 'r' : p == 'b');
+}
+
+// Calls visit(target) for every square the piece on `sq` attacks.
+template <typename Visit>
+void forEachAttack(const std::array<char, 64>& on, int sq, Visit visit) {
+  const char piece = on[static_cast<std::size_t>(sq)];
+  const bool white = isWhitePiece(piece);
+  const int f = sq % 8, r = sq / 8;
+  auto step = [&](int df, int dr) {
+    const int nf = f + df, nr = r + dr;
+    if (nf >= 0 && nf < 8 && nr >= 0 && nr < 8) visit(nr * 8 + nf);
+  };
+  switch (pieceType(piece)) {
+    case 'p':
+      step(-1, white ? 1 : -1);
+      step(1, white ? 1 : -1);
+      return;
+    case 'n':
+      for (const auto& d : kKnightJumps) step(d[0], d[1]);
+      return;
+    case 'k':
+      for (const auto& d : kDirections) step(d[0], d[1]);
+      return;
+    default:
+      break;
+  }
+  for (int d = 0; d < 8; ++d) {
+    if (!slidesAlong(piece, d)) continue;
+    int nf = f + kDirections[d][0], nr = r + kDirections[d][1];
+    while (nf >= 0 && nf < 8 && nr >= 0 && nr < 8) {
+      visit(nr * 8 + nf);
+      if (on[static_cast<std::size_t>(nr * 8 + nf)] != '.') break;
+      nf += kDirections[d][0];
+      nr += kDirections[d][1];
+    }
+  }
+}
+
+void addAttacks(AttackMaps& maps, const std::array<char, 64>& on, int sq, int sign) {
+  const std::size_t side = isWhitePiece(on[static_cast<std::size_t>(sq)]) ? 0 : 1;
+  forEachAttack(on, sq, [&](int target) {
+    auto& n = maps.count[side][static_cast<std::size_t>(target)];
+    n = static_cast<std::uint8_t>(n + sign);
+    if (n) maps.bySide[side] |= 1ULL << target;
+    else maps.bySide[side] &= ~(1ULL << target);
+  });
+}
+
+// Squares a move's dirty pieces left or entered.
+std::uint64_t changedSquares(const DirtyPieces& dirty) {
+  std::uint64_t changed = 0;
+  for (int i = 0; i < dirty.count; ++i) {
+    const DirtyPiece& d = dirty.pieces[static_cast<std::size_t>(i)];
+    if (d.from >= 0) changed |= 1ULL << d.from;
+    if (d.to >= 0) changed |= 1ULL << d.to;
+  }
+  return changed;
+}
+
+// Brings `maps` from `before` to `after`, which differ only on `changed`.
+// Only pieces on changed squares and sliders that saw a changed square on
+// `before` can attack differently: a slider that sees one on `after` saw the
+// nearest changed square on that line before.
+void updateAttackMaps(AttackMaps& maps, const std::array<char, 64>& before, const std::array<char, 64>& after,
+                      std::uint64_t changed) {
+  std::uint64_t affected = changed;
+  for (std::uint64_t bits = changed; bits; bits &= bits - 1) {
+    const int sq = __builtin_ctzll(bits);
+    for (int d = 0; d < 8; ++d) {
+      // The first piece outward from sq along d sees sq if it slides back along d.
+      int nf = sq % 8 + kDirections[d][0], nr = sq / 8 + kDirections[d][1];
+      while (nf >= 0 && nf < 8 && nr >= 0 && nr < 8) {
+        const char p = before[static_cast<std::size_t>(nr * 8 + nf)];
+        if (p != '.') {
+          if (slidesAlong(p, d)) affected |= 1ULL << (nr * 8 + nf);
+          break;
+        }
+        nf += kDirections[d][0];
+        nr += kDirections[d][1];
+      }
+    }
+  }
+  for (std::uint64_t bits = affected; bits; bits &= bits - 1) {
+    const int sq = __builtin_ctzll(bits);
+    if (before[static_cast<std::size_t>(sq)] != '.') addAttacks(maps, before, sq, -1);
+  }
+  for (std::uint64_t bits = affected; bits; bits &= bits - 1) {
+    const int sq = __builtin_ctzll(bits);
+    if (after[static_cast<std::size_t>(sq)] != '.') addAttacks(maps, after, sq, 1);
+  }
+}
+
+}  // namespace
+
 void Board::clear() {
   squares.fill('.');
   whiteToMove = true;
@@ -13,6 +120,15 @@ void Board::clear() {
   halfmoveClock = 0;
   fullmoveNumber = 1;
   history.clear();
+  attacks = AttackMaps{};
+}
+
+void Board::enableAttackMaps() {
+  trackAttacks = true;
+  attacks = AttackMaps{};
+  for (int sq = 0; sq < 64; ++sq) {
+    if (squares[static_cast<std::size_t>(sq)] != '.') addAttacks(attacks, squares, sq, 1);
+  }
 }
 
 void Board::setStartPos() {
@@ -57,10 +173,12 @@ bool Board::setFromFEN(const std::string& fen) {
   if (castling.find('k') != std::string::npos) castlingRights |= 4;
   if (castling.find('q') != std::string::npos) castlingRights |= 8;
   enPassantSquare = (ep == "-") ? -1 : squareIndex(ep[0], ep[1]);
+  if (trackAttacks) enableAttackMaps();
   return true;
 }
 
 bool Board::isSquareAttacked(int sq, bool byWhite) const {
+  if (trackAttacks) return attackerCount(sq, byWhite) > 0;
   int f = sq % 8, r = sq / 8;
   int pawnDir = byWhite ? -1 : 1;
   for (int df : {-1, 1}) {
@@ -81,7 +199,7 @@ bool Board::isSquareAttacked(int sq, bool byWhite) const {
     while (nf >= 0 && nf < 8 && nr >= 0 && nr < 8) {
       char p = squares[nr * 8 + nf];
       if (p != '.') {
-        if (std::isupper(static_cast<unsigned char>(p)) == byWhite) {
+        if ((std::isupper(static_cast<unsigned char>(p)) != 0) == byWhite) {
           char q = static_cast<char>(std::tolower(static_cast<unsigned char>(p)));
           for (int i = 0; set[i]; ++i) if (set[i] == q) return true;
         }
@@ -123,6 +241,7 @@ bool Board::makeMove(int from, int to, char promotion, Undo& u) {
 
   bool movingWhite = std::isupper(static_cast<unsigned char>(u.moved));
   if (movingWhite != whiteToMove) return false;
+  const std::array<char, 64> before = squares;
 
   enPassantSquare = -1;
   if (std::tolower(static_cast<unsigned char>(u.moved)) == 'p' || u.captured != '.') halfmoveClock = 0;
@@ -163,8 +282,22 @@ bool Board::makeMove(int from, int to, char promotion, Undo& u) {
     else if (to == 58) { squares[59] = 'r'; squares[56] = '.'; }
   }
 
+  if (u.wasPromotion) {
+    u.dirty.add(u.moved, from, -1);
+    u.dirty.add(squares[to], -1, to);
+  } else {
+    u.dirty.add(u.moved, from, to);
+  }
+  if (u.captured != '.') u.dirty.add(u.captured, u.capturedSquare, -1);
+  if (u.wasCastle && (to == 6 || to == 2 || to == 62 || to == 58)) {
+    const bool kingSide = (to % 8) == 6;
+    const int rank = to - (to % 8);
+    u.dirty.add(movingWhite ? 'R' : 'r', rank + (kingSide ? 7 : 0), rank + (kingSide ? 5 : 3));
+  }
+
   whiteToMove = !whiteToMove;
   if (whiteToMove) ++fullmoveNumber;
+  if (trackAttacks) updateAttackMaps(attacks, before, squares, changedSquares(u.dirty));
 
   if (inCheck(!whiteToMove)) {
     unmakeMove(from, to, promotion, u);
@@ -175,6 +308,7 @@ bool Board::makeMove(int from, int to, char promotion, Undo& u) {
 
 void Board::unmakeMove(int from, int to, char promotion, const Undo& u) {
   (void)promotion;
+  const std::array<char, 64> before = squares;
   whiteToMove = u.prevWhiteToMove;
   castlingRights = u.prevCastling;
   enPassantSquare = u.prevEnPassant;
@@ -191,6 +325,7 @@ void Board::unmakeMove(int from, int to, char promotion, const Undo& u) {
   squares[from] = u.moved;
   squares[to] = '.';
   if (u.capturedSquare >= 0) squares[u.capturedSquare] = u.captured;
+  if (trackAttacks) updateAttackMaps(attacks, before, squares, changedSquares(u.dirty));
 }
 
 }  // namespace board
@@ -8,6 +8,25 @@
 
 namespace board {
 
+// A piece a move put on, took off or moved across the board: `from` is -1
+// for a piece that appears (promotion), `to` is -1 for one that leaves
+// (capture, promoted pawn). Incremental consumers such as the NNUE
+// accumulator replay these instead of rescanning the board.
+struct DirtyPiece {
+  char piece = '.';
+  int from = -1;
+  int to = -1;
+};
+
+// At most three: the mover (or promoting pawn plus its new piece), a
+// captured piece, or the castling rook.
+struct DirtyPieces {
+  std::array<DirtyPiece, 3> pieces{};
+  int count = 0;
+
+  void add(char piece, int from, int to) { pieces[static_cast<std::size_t>(count++)] = DirtyPiece{piece, from, to}; }
+};
+
 struct Undo {
   int prevEnPassant = -1;
   std::uint8_t prevCastling = 0;
@@ -20,6 +39,14 @@ struct Undo {
   bool wasEnPassant = false;
   bool wasCastle = false;
   bool wasPromotion = false;
+  DirtyPieces dirty;
+};
+
+// Squares each side attacks and how many of its pieces attack each one.
+// Index 0 is White, 1 is Black.
+struct AttackMaps {
+  std::array<std::uint64_t, 2> bySide{};
+  std::array<std::array<std::uint8_t, 64>, 2> count{};
 };
 
 struct Board {
@@ -30,6 +57,11 @@ struct Board {
   int halfmoveClock = 0;
   int fullmoveNumber = 1;
   std::vector<std::string> history;
+  // Off by default. Once enabled, make/unmake and setFromFEN keep the maps
+  // current by recomputing only the pieces whose attacks a move can change;
+  // call enableAttackMaps() again after editing squares directly.
+  bool trackAttacks = false;
+  AttackMaps attacks;
 
   void clear();
   void setStartPos();
@@ -39,11 +71,15 @@ struct Board {
   static std::string squareName(int sq);
 
   char pieceAt(int idx) const;
+  void enableAttackMaps();
+  // Attackers of `sq`; needs trackAttacks.
+  int attackerCount(int sq, bool byWhite) const { return attacks.count[byWhite ? 0 : 1][static_cast<std::size_t>(sq)]; }
   bool isSquareAttacked(int sq, bool byWhite) const;
   bool inCheck(bool white) const;
   bool makeMove(int from, int to, char promotion, Undo& u);
   void unmakeMove(int from, int to, char promotion, const Undo& u);
 
+
   bool applyMove(int from, int to, char promotion = '\0') {
     Undo u;
     return makeMove(from, to, promotion, u);
@@ -11,8 +11,10 @@
 #include <cstring>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <fstream>
 #include <future>
+#include <memory>
 #include <numeric>
 #include <sstream>
 #include <string>
@@ -20,7 +22,10 @@
 #include <utility>
 #include <vector>
 
+#include "eval.h"
+#include "mapped_file.h"
 #include "movegen.h"
+#include "simd.h"
 
 namespace engine_components {
 
@@ -121,6 +126,17 @@ struct SEE {
     if (m.promotion != '\0') gain += pieceValue(m.promotion) - 100;
     return gain;
   }
+
+  // With the board's attack maps, a move onto a square the opponent attacks
+  // is assumed to lose the mover.
+  int estimate(const movegen::Move& m, const board::Board& b) const {
+    const int gain = estimate(m, &b.squares);
+    if (!b.trackAttacks || m.from < 0 || m.to < 0 || m.from >= 64 || m.to >= 64) return gain;
+    const char mover = b.squares[static_cast<std::size_t>(m.from)];
+    const bool white = std::isupper(static_cast<unsigned char>(mover)) != 0;
+    if (b.attackerCount(m.to, !white) == 0) return gain;
+    return gain - (pieceValue(mover) - pieceValue(mover) / 8);
+  }
 };
 
 struct SearchResultCache {
@@ -158,26 +174,37 @@ struct Handcrafted {
   int psqt = 0;
   int pawnStructure = 0;
   int kingSafety = 0;
+  int kingActivity = 0;
   int mobility = 0;
-  int space = 0;
   int bishopPair = 0;
-  int rookActivity = 0;
-  int tropism = 0;
+  int rookPair = 0;
+  int imbalance = 0;
   int tempo = 0;
-  int initiative = 0;
-  int timeAwareness = 0;
+
+  // Copies the white-relative terms recorded by eval::trace.
+  void assign(const eval::Trace& t) {
+    material = t.material;
+    psqt = t.psqt;
+    pawnStructure = t.pawnStructure;
+    kingSafety = t.kingSafety;
+    kingActivity = t.kingActivity;
+    mobility = t.mobility;
+    bishopPair = t.bishopPair;
+    rookPair = t.rookPair;
+    imbalance = t.imbalance;
+    tempo = t.tempo;
+  }
 
   int score() const {
-    return material + psqt + pawnStructure + kingSafety + mobility + space + bishopPair + rookActivity + tropism +
-           tempo + initiative + timeAwareness;
+    return material + psqt + pawnStructure + kingSafety + kingActivity + mobility + bishopPair + rookPair + imbalance +
+           tempo;
   }
 
   std::string breakdown() const {
     std::ostringstream oss;
     oss << "material=" << material << " psqt=" << psqt << " pawn=" << pawnStructure << " king=" << kingSafety
-        << " mobility=" << mobility << " space=" << space << " bishopPair=" << bishopPair
-        << " rookActivity=" << rookActivity << " tropism=" << tropism << " tempo=" << tempo
-        << " initiative=" << initiative << " timeAwareness=" << timeAwareness;
+        << " kingActivity=" << kingActivity << " mobility=" << mobility << " bishopPair=" << bishopPair
+        << " rookPair=" << rookPair << " imbalance=" << imbalance << " tempo=" << tempo;
     return oss.str();
   }
 };
@@ -189,322 +216,811 @@ struct EndgameHeuristics {
   int evaluate(bool deepEndgame) const { return deepEndgame ? kingPawnPattern + specializedScore : 0; }
 };
 
+// Read-only run of weights that lives in a shared buffer.
+template <typename T>
+struct ConstSpan {
+  const T* ptr = nullptr;
+  std::size_t count = 0;
+
+  const T* data() const { return ptr; }
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const T& operator[](std::size_t i) const { return ptr[i]; }
+  const T* begin() const { return ptr; }
+  const T* end() const { return ptr + count; }
+};
+
 struct NNUEConfig {
-  int inputs = 2048;      // extended HalfKP + threat features
-  int hidden1 = 3072;     // larger accumulator target range
+  int inputs = 6144;      // HalfKA: king bucket x piece plane x square, per perspective
+  int hidden1 = 3072;     // both perspective halves; a multiple of 2 * simd::kSparseGroup
   int hidden2 = 1024;     // post-accumulator mixer
   bool useSCReLU = true;  // squared clipped ReLU in first hidden layer
-  bool useAMXPath = false;
-  int draftHidden1 = 512; // tiny fast path width for lazy evaluation
+  int draftHidden1 = 512; // units per perspective the draft head reads
   int miniQSearchHidden = 256;
   float policyPruneFloor = 0.05f;
 };
 
+// Inference runs entirely on integers. The first layer (feature transformer)
+// is int16 with 1.0 == simd::kFtMax, its activations are uint8 in
+// [0, simd::kActivationMax], and the two upper layers are int8 with a
+// power-of-two per-tensor scale, so requantizing a layer is a shift. A
+// legacy float nnue.bin is quantized once at load time; `quantize` writes
+// the versioned net file, which later loads map and use in place.
+//
+// Inputs are HalfKA. Each perspective (White, Black) sees one binary feature
+// per piece, kings included, indexed by the bucket of its own king, whether
+// the piece is its own or the opponent's, and the square as seen from its
+// side (Black's view is flipped vertically). Both perspectives share w1 and
+// each fills half of the accumulator; the upper layers read the side to
+// move's half first. Every feature is toggled by the move that places or
+// removes its piece, so only king-bucket changes need a refresh.
 struct NNUE {
+  // Net file: a FileHeader, then the payload in inference layout with every
+  // section on a kSectionAlign boundary, so a mapped file is used in place.
+  static constexpr std::uint32_t kFileMagic = 0x45554e4eu;  // "NNUE"
+  static constexpr std::uint32_t kFileVersion = 2;  // 2: draft head
+  // int16 w1/b1 at simd::kFtMax, int8 w2/w3 at 2^shift, int32 b2/b3 at
+  // kActivationMax * 2^shift, w2 in simd::sparseIndex order.
+  static constexpr std::uint32_t kQuantScheme = 1;
+  static constexpr std::size_t kSectionAlign = 64;
+  // Earlier "NNQ<n>" quantized files, rejected.
+  static constexpr std::uint32_t kLegacyTag = 0x00514e4eu;
+  static constexpr std::uint32_t kLegacyTagMask = 0x00ffffffu;
+  static constexpr int kMaxWeightShift = 16;
+  static constexpr int kPerspectives = 2;  // White, Black
+  static constexpr int kKingBuckets = 8;
+  static constexpr int kPlaneInputs = 12 * 64;
+
   bool enabled = true;
   std::string weightsPath = "nnue.bin";
   NNUEConfig cfg{};
-  std::vector<float> w1;
-  std::vector<float> b1;
-  std::vector<float> w2;
-  std::vector<float> b2;
-  std::vector<float> w3;
-  float b3 = 0.0f;
+  // w1 and w2 view `weights`: a mapped net file or a heap buffer with the
+  // same payload layout, shared by every copy of the net. The small tensors
+  // are owned copies.
+  std::shared_ptr<const void> weights;
+  bool weightsMapped = false;
+  // Feature-major: the weights of input i are the contiguous row
+  // w1[i * hidden1 / 2 ...], so toggling a feature is one vector add.
+  ConstSpan<std::int16_t> w1;
+  simd::AlignedVector<std::int16_t> b1;  // one perspective half; distillStrategicHint adjusts it
+  // Input-group rows (simd::sparseIndex), so layer 2 only reads the rows of
+  // activations that survived the clipped ReLU.
+  ConstSpan<std::int8_t> w2;
+  std::vector<std::int32_t> b2;
+  std::vector<std::int8_t> w3;
+  std::int32_t b3 = 0;
+  int l2Shift = 0;  // w2 holds round(w * 2^l2Shift)
+  int l3Shift = 0;
+  // Draft head for lazy evaluation: one output read straight from the
+  // activated first draftUnits() of each accumulator half, side to move
+  // first. Quantized like w3.
+  std::vector<std::int8_t> wd;
+  std::int32_t bd = 0;
+  int draftShift = 0;
+
+  struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::int32_t inputs;
+    std::int32_t hidden1;
+    std::int32_t hidden2;
+    std::int32_t kingBuckets;
+    std::uint32_t scheme;
+    std::int32_t ftScale;
+    std::int32_t l2Shift;
+    std::int32_t l3Shift;
+    std::int32_t sparseGroup;
+    std::int32_t draftUnits;
+    std::int32_t draftShift;
+    std::uint32_t reserved[15];
+    std::uint64_t payloadBytes;
+    std::uint64_t checksum;  // payloadChecksum()
+  };
+  static_assert(sizeof(FileHeader) % kSectionAlign == 0, "the payload must start aligned");
+
+  // Payload byte offsets of each tensor.
+  struct Layout {
+    std::size_t w1, b1, w2, b2, w3, b3, wd, bd, bytes;
+  };
+
+  struct FloatWeights {
+    std::vector<float> w1;
+    std::vector<float> b1;
+    std::vector<float> w2;
+    std::vector<float> b2;
+    std::vector<float> w3;
+    float b3 = 0.0f;
+  };
+
+  // Sparse input: the active feature indices of each perspective, about 32
+  // each, so building an accumulator is one row per piece.
+  struct FeatureList {
+    std::array<std::vector<std::uint16_t>, kPerspectives> active;  // ascending
+    std::array<int, kPerspectives> kingBucket{};
+    bool whiteToMove = true;
 
+    bool empty() const { return active[0].empty() && active[1].empty(); }
+  };
+
+  // hidden1 holds the White half, then the Black half.
   struct Accumulator {
-    std::vector<float> hidden1;
-    std::vector<float> features;
+    simd::AlignedVector<std::int16_t> hidden1;
+    FeatureList features;
     bool initialized = false;
   };
 
+  using PieceBitboards = std::array<std::uint64_t, 12>;
+
+  // One perspective's accumulator half last built for one king bucket, and
+  // the pieces it holds.
+  struct RefreshEntry {
+    simd::AlignedVector<std::int16_t> hidden1;
+    PieceBitboards pieces{};
+  };
+
+  // Per-thread refresh cache. A refresh starts from the entry of its bucket
+  // and applies only the pieces that differ from the cached board, so a king
+  // move into another bucket costs a handful of rows instead of every active
+  // one. Entries belong to the weights they were built with: clear() after
+  // loading a net.
+  struct RefreshCache {
+    std::vector<RefreshEntry> entries;
+
+    void clear() { entries.clear(); }
+
+    // An empty entry stands for an empty board: just the bias.
+    RefreshEntry& entry(const NNUE& net, int bucket, int perspective) {
+      if (entries.empty()) entries.resize(static_cast<std::size_t>(kKingBuckets * kPerspectives));
+      RefreshEntry& e = entries[static_cast<std::size_t>(bucket * kPerspectives + perspective)];
+      if (e.hidden1.empty()) e.hidden1.assign(net.b1.begin(), net.b1.end());
+      return e;
+    }
+  };
+
+  int halfUnits() const { return cfg.hidden1 / kPerspectives; }
+  int draftUnits() const { return std::min(halfUnits(), std::max(64, cfg.draftHidden1)); }
+
   std::size_t parameterCount() const {
-    return static_cast<std::size_t>(cfg.inputs) * cfg.hidden1 + static_cast<std::size_t>(cfg.hidden1) +
+    return static_cast<std::size_t>(cfg.inputs) * halfUnits() + static_cast<std::size_t>(halfUnits()) +
            static_cast<std::size_t>(cfg.hidden1) * cfg.hidden2 + static_cast<std::size_t>(cfg.hidden2) +
            static_cast<std::size_t>(cfg.hidden2) + 1;
   }
 
-  void initializeWeights() {
-    w1.assign(static_cast<std::size_t>(cfg.inputs * cfg.hidden1), 0.0f);
-    b1.assign(static_cast<std::size_t>(cfg.hidden1), 0.0f);
-    w2.assign(static_cast<std::size_t>(cfg.hidden1 * cfg.hidden2), 0.0f);
-    b2.assign(static_cast<std::size_t>(cfg.hidden2), 0.0f);
-    w3.assign(static_cast<std::size_t>(cfg.hidden2), 0.0f);
+  FloatWeights syntheticWeights() const {
+    FloatWeights f;
+    f.w1.assign(static_cast<std::size_t>(cfg.inputs) * halfUnits(), 0.0f);
+    f.b1.assign(static_cast<std::size_t>(halfUnits()), 0.0f);
+    f.w2.assign(static_cast<std::size_t>(cfg.hidden1) * cfg.hidden2, 0.0f);
+    f.b2.assign(static_cast<std::size_t>(cfg.hidden2), 0.0f);
+    f.w3.assign(static_cast<std::size_t>(cfg.hidden2), 0.0f);
+
+    for (std::size_t i = 0; i < f.w1.size(); ++i) f.w1[i] = static_cast<float>((static_cast<int>(i % 31) - 15) * 0.002f);
+    for (std::size_t i = 0; i < f.w2.size(); ++i) f.w2[i] = static_cast<float>((static_cast<int>(i % 19) - 9) * 0.003f);
+    for (std::size_t i = 0; i < f.w3.size(); ++i) f.w3[i] = static_cast<float>((static_cast<int>(i % 11) - 5) * 0.01f);
+    return f;
+  }
 
-    for (std::size_t i = 0; i < w1.size(); ++i) w1[i] = static_cast<float>((static_cast<int>(i % 31) - 15) * 0.002f);
-    for (std::size_t i = 0; i < w2.size(); ++i) w2[i] = static_cast<float>((static_cast<int>(i % 19) - 9) * 0.003f);
-    for (std::size_t i = 0; i < w3.size(); ++i) w3[i] = static_cast<float>((static_cast<int>(i % 11) - 5) * 0.01f);
+  // Largest shift that still maps max|w| into int8.
+  static int weightShift(const std::vector<float>& w) {
+    float maxAbs = 0.0f;
+    for (float v : w) maxAbs = std::max(maxAbs, std::fabs(v));
+    int shift = 0;
+    while (shift < kMaxWeightShift && maxAbs * static_cast<float>(1 << (shift + 1)) <= 127.0f) ++shift;
+    return shift;
   }
 
-  bool load(const std::string& path) {
-    weightsPath = path;
-    initializeWeights();
+  Layout layout() const {
+    auto next = [](std::size_t at, std::size_t bytes) {
+      return (at + bytes + kSectionAlign - 1) / kSectionAlign * kSectionAlign;
+    };
+    const std::size_t half = static_cast<std::size_t>(halfUnits());
+    const std::size_t h1 = static_cast<std::size_t>(cfg.hidden1);
+    const std::size_t h2 = static_cast<std::size_t>(cfg.hidden2);
+    Layout l{};
+    l.w1 = 0;
+    l.b1 = next(l.w1, static_cast<std::size_t>(cfg.inputs) * half * sizeof(std::int16_t));
+    l.w2 = next(l.b1, half * sizeof(std::int16_t));
+    l.b2 = next(l.w2, h1 * h2);
+    l.w3 = next(l.b2, h2 * sizeof(std::int32_t));
+    l.b3 = next(l.w3, h2);
+    l.wd = next(l.b3, sizeof(std::int32_t));
+    l.bd = next(l.wd, static_cast<std::size_t>(kPerspectives * draftUnits()));
+    l.bytes = next(l.bd, sizeof(std::int32_t));
+    return l;
+  }
 
-    std::ifstream in(path, std::ios::binary);
-    if (in) {
-      in.read(reinterpret_cast<char*>(w1.data()), static_cast<std::streamsize>(w1.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(b1.data()), static_cast<std::streamsize>(b1.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(w2.data()), static_cast<std::streamsize>(w2.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(b2.data()), static_cast<std::streamsize>(b2.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(w3.data()), static_cast<std::streamsize>(w3.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(&b3), static_cast<std::streamsize>(sizeof(b3)));
+  // Multiply-rotate hash over 8-byte words; payloads are whole sections.
+  static std::uint64_t payloadChecksum(const unsigned char* p, std::size_t bytes) {
+    std::uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (std::size_t i = 0; i + 8 <= bytes; i += 8) {
+      std::uint64_t word;
+      std::memcpy(&word, p + i, sizeof(word));
+      h ^= word;
+      h = ((h << 29) | (h >> 35)) * 0xbf58476d1ce4e5b9ULL;
     }
+    return h;
+  }
 
-    enabled = true;
-    return true;
+  // Points w1 and w2 into `payload` and copies the small tensors out of it.
+  void bindPayload(std::shared_ptr<const void> owner, const unsigned char* payload) {
+    const Layout l = layout();
+    const std::size_t half = static_cast<std::size_t>(halfUnits());
+    const std::size_t h2 = static_cast<std::size_t>(cfg.hidden2);
+    auto at = [&](std::size_t offset) { return payload + offset; };
+    w1 = {reinterpret_cast<const std::int16_t*>(at(l.w1)), static_cast<std::size_t>(cfg.inputs) * half};
+    w2 = {reinterpret_cast<const std::int8_t*>(at(l.w2)), static_cast<std::size_t>(cfg.hidden1) * h2};
+    const auto* bias1 = reinterpret_cast<const std::int16_t*>(at(l.b1));
+    const auto* bias2 = reinterpret_cast<const std::int32_t*>(at(l.b2));
+    const auto* out3 = reinterpret_cast<const std::int8_t*>(at(l.w3));
+    const auto* draft = reinterpret_cast<const std::int8_t*>(at(l.wd));
+    b1.assign(bias1, bias1 + half);
+    b2.assign(bias2, bias2 + h2);
+    w3.assign(out3, out3 + h2);
+    std::memcpy(&b3, at(l.b3), sizeof(b3));
+    wd.assign(draft, draft + kPerspectives * draftUnits());
+    std::memcpy(&bd, at(l.bd), sizeof(bd));
+    weights = std::move(owner);
   }
 
-  static std::vector<float> extractFeatures(const std::array<char, 64>& squares, bool whiteToMove, int inputSize) {
-    std::vector<float> f(static_cast<std::size_t>(inputSize), 0.0f);
-    auto piecePlane = [](char p) {
-      switch (p) {
-        case 'P': return 0; case 'N': return 1; case 'B': return 2; case 'R': return 3; case 'Q': return 4; case 'K': return 5;
-        case 'p': return 6; case 'n': return 7; case 'b': return 8; case 'r': return 9; case 'q': return 10; case 'k': return 11;
-        default: return -1;
-      }
+  void quantize(const FloatWeights& f) {
+    auto toInt16 = [](float v, float scale) {
+      return static_cast<std::int16_t>(std::clamp<long>(std::lround(v * scale), -32767, 32767));
     };
-    for (int sq = 0; sq < 64; ++sq) {
-      int plane = piecePlane(squares[static_cast<std::size_t>(sq)]);
-      if (plane < 0) continue;
-      int idx = plane * 64 + sq;
-      if (idx >= 0 && idx < inputSize) f[static_cast<std::size_t>(idx)] = 1.0f;
-    }
-    if (inputSize > 768) f[768] = whiteToMove ? 1.0f : -1.0f;
-
-    int whiteBishops = 0;
-    int blackBishops = 0;
-    int whiteRooks = 0;
-    int blackRooks = 0;
-    std::array<int, 8> whitePawns{};
-    std::array<int, 8> blackPawns{};
-    for (int sq = 0; sq < 64; ++sq) {
-      const char c = squares[static_cast<std::size_t>(sq)];
-      if (c == 'B') ++whiteBishops;
-      if (c == 'b') ++blackBishops;
-      if (c == 'R') ++whiteRooks;
-      if (c == 'r') ++blackRooks;
-      if (c == 'P') ++whitePawns[static_cast<std::size_t>(sq % 8)];
-      if (c == 'p') ++blackPawns[static_cast<std::size_t>(sq % 8)];
-    }
-
-    if (inputSize > 769) f[769] = (whiteBishops >= 2 ? 1.0f : 0.0f) - (blackBishops >= 2 ? 1.0f : 0.0f);
-    if (inputSize > 770) f[770] = (whiteRooks >= 2 ? 1.0f : 0.0f) - (blackRooks >= 2 ? 1.0f : 0.0f);
-
-    auto pawnPenalty = [](const std::array<int, 8>& files) {
-      float p = 0.0f;
-      for (int file = 0; file < 8; ++file) {
-        if (files[static_cast<std::size_t>(file)] > 1) p += 0.5f;
-        const bool left = file > 0 && files[static_cast<std::size_t>(file - 1)] > 0;
-        const bool right = file < 7 && files[static_cast<std::size_t>(file + 1)] > 0;
-        if (files[static_cast<std::size_t>(file)] > 0 && !left && !right) p += 0.5f;
-      }
-      return p;
+    auto toInt8 = [](float v, float scale) {
+      return static_cast<std::int8_t>(std::clamp<long>(std::lround(v * scale), -127, 127));
+    };
+    auto toInt32 = [](float v, double scale) {
+      return static_cast<std::int32_t>(std::clamp<long long>(std::llround(v * scale), -(1LL << 30), 1LL << 30));
     };
 
-    if (inputSize > 771) f[771] = pawnPenalty(blackPawns) - pawnPenalty(whitePawns);
-    if (inputSize > 772) f[772] = whiteToMove ? 0.5f : -0.5f;
+    // The result is built as a file payload so it binds like a mapped net.
+    const Layout l = layout();
+    auto payload = std::make_shared<simd::AlignedVector<unsigned char>>(l.bytes, 0);
+    unsigned char* base = payload->data();
+    auto* qw1 = reinterpret_cast<std::int16_t*>(base + l.w1);
+    auto* qb1 = reinterpret_cast<std::int16_t*>(base + l.b1);
+    auto* qw2 = reinterpret_cast<std::int8_t*>(base + l.w2);
+    auto* qb2 = reinterpret_cast<std::int32_t*>(base + l.b2);
+    auto* qw3 = reinterpret_cast<std::int8_t*>(base + l.w3);
+
+    // Float files store w1 unit-major ([h * inputs + i]); transpose here.
+    const float ftScale = static_cast<float>(simd::kFtMax);
+    const std::size_t inputs = static_cast<std::size_t>(cfg.inputs);
+    const std::size_t half = static_cast<std::size_t>(halfUnits());
+    for (std::size_t h = 0; h < half; ++h) {
+      for (std::size_t i = 0; i < inputs; ++i) qw1[i * half + h] = toInt16(f.w1[h * inputs + i], ftScale);
+    }
+    for (std::size_t i = 0; i < f.b1.size(); ++i) qb1[i] = toInt16(f.b1[i], ftScale);
 
-    auto addThreatSlice = [&](int offset, bool whiteSide) {
-      int directAttacks = 0;
-      int pinnedPieces = 0;
-      int mobilitySquares = 0;
-      int kingSq = -1;
-      for (int sq = 0; sq < 64; ++sq) {
-        const char c = squares[static_cast<std::size_t>(sq)];
-        if (c == '.') continue;
-        const bool isWhite = std::isupper(static_cast<unsigned char>(c));
-        if (std::tolower(static_cast<unsigned char>(c)) == 'k' && isWhite == whiteSide) kingSq = sq;
+    // Biases live in the accumulator domain: activation scale times weight scale.
+    l2Shift = weightShift(f.w2);
+    const float s2 = static_cast<float>(1 << l2Shift);
+    for (int o = 0; o < cfg.hidden2; ++o) {
+      for (int h = 0; h < cfg.hidden1; ++h) {
+        qw2[simd::sparseIndex(o, h, cfg.hidden2)] = toInt8(f.w2[static_cast<std::size_t>(o) * cfg.hidden1 + h], s2);
       }
-      for (int sq = 0; sq < 64; ++sq) {
-        const char c = squares[static_cast<std::size_t>(sq)];
-        if (c == '.') continue;
-        const bool isWhite = std::isupper(static_cast<unsigned char>(c));
-        if (isWhite != whiteSide) continue;
-        const int rank = sq / 8;
-        const int file = sq % 8;
-        const char p = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-
-        if (p == 'n') {
-          constexpr int kD[8][2] = {{1,2},{2,1},{2,-1},{1,-2},{-1,-2},{-2,-1},{-2,1},{-1,2}};
-          for (auto& d : kD) {
-            const int nf = file + d[0];
-            const int nr = rank + d[1];
-            if (nf < 0 || nf > 7 || nr < 0 || nr > 7) continue;
-            ++mobilitySquares;
-            const int to = nr * 8 + nf;
-            const char dst = squares[static_cast<std::size_t>(to)];
-            if (dst != '.' && (std::isupper(static_cast<unsigned char>(dst)) != isWhite)) ++directAttacks;
-          }
-        }
-
-        if (p == 'b' || p == 'r' || p == 'q') {
-          const std::array<std::pair<int, int>, 8> dirs{{{1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1}}};
-          const int fromKingDist = kingSq >= 0 ? std::abs((kingSq % 8) - file) + std::abs((kingSq / 8) - rank) : 10;
-          for (const auto& [df, dr] : dirs) {
-            if ((p == 'b') && (df == 0 || dr == 0)) continue;
-            if ((p == 'r') && (df != 0 && dr != 0)) continue;
-            int nf = file + df;
-            int nr = rank + dr;
-            bool seenOwn = false;
-            while (nf >= 0 && nf <= 7 && nr >= 0 && nr <= 7) {
-              ++mobilitySquares;
-              const int to = nr * 8 + nf;
-              const char dst = squares[static_cast<std::size_t>(to)];
-              if (dst == '.') {
-                nf += df;
-                nr += dr;
-                continue;
-              }
-              if (std::isupper(static_cast<unsigned char>(dst)) != isWhite) ++directAttacks;
-              if (std::isupper(static_cast<unsigned char>(dst)) == isWhite) {
-                if (seenOwn && fromKingDist <= 2) ++pinnedPieces;
-                seenOwn = true;
-              }
-              break;
-            }
-          }
-        }
+    }
+    for (std::size_t i = 0; i < f.b2.size(); ++i) qb2[i] = toInt32(f.b2[i], static_cast<double>(simd::kActivationMax) * s2);
+
+    l3Shift = weightShift(f.w3);
+    const float s3 = static_cast<float>(1 << l3Shift);
+    for (std::size_t i = 0; i < f.w3.size(); ++i) qw3[i] = toInt8(f.w3[i], s3);
+    const std::int32_t qb3 = toInt32(f.b3, static_cast<double>(simd::kActivationMax) * s3);
+    std::memcpy(base + l.b3, &qb3, sizeof(qb3));
+
+    // Float files carry no draft head, so it is the upper layers collapsed
+    // to one linear map (their ReLU dropped) restricted to the draft units.
+    const int draft = draftUnits();
+    std::vector<float> fd(static_cast<std::size_t>(kPerspectives * draft), 0.0f);
+    double fbd = f.b3;
+    for (int o = 0; o < cfg.hidden2; ++o) {
+      const float w = f.w3[static_cast<std::size_t>(o)];
+      const float* in = &f.w2[static_cast<std::size_t>(o) * cfg.hidden1];
+      for (int j = 0; j < kPerspectives * draft; ++j) {
+        fd[static_cast<std::size_t>(j)] += w * in[j < draft ? j : static_cast<int>(half) + j - draft];
       }
+      fbd += static_cast<double>(w) * f.b2[static_cast<std::size_t>(o)];
+    }
+    draftShift = weightShift(fd);
+    const float sd = static_cast<float>(1 << draftShift);
+    auto* qwd = reinterpret_cast<std::int8_t*>(base + l.wd);
+    for (std::size_t j = 0; j < fd.size(); ++j) qwd[j] = toInt8(fd[j], sd);
+    const std::int32_t qbd = toInt32(static_cast<float>(fbd), static_cast<double>(simd::kActivationMax) * sd);
+    std::memcpy(base + l.bd, &qbd, sizeof(qbd));
+
+    bindPayload(payload, base);
+    weightsMapped = false;
+  }
 
-      for (int i = 0; i < 1024; ++i) {
-        const int idx = offset + i;
-        if (idx >= inputSize) break;
-        float v = 0.0f;
-        if (i < 340) v = static_cast<float>(directAttacks) / 32.0f;
-        else if (i < 680) v = static_cast<float>(pinnedPieces) / 8.0f;
-        else v = static_cast<float>(mobilitySquares) / 128.0f;
-        f[static_cast<std::size_t>(idx)] = whiteSide ? v : -v;
-      }
+  // Accepts a net file (kFileMagic), which is mapped and used in place, or
+  // the raw float layout, which is quantized here and must match the
+  // configured dimensions exactly. A missing file selects the synthetic
+  // weights; anything malformed leaves them in place and returns false.
+  bool load(const std::string& path) {
+    weightsPath = path;
+    enabled = true;
+
+    const auto file = mapped_file::open(path);
+    if (!file) {
+      quantize(syntheticWeights());
+      return true;
+    }
+    std::uint32_t magic = 0;
+    if (file->size >= sizeof(magic)) std::memcpy(&magic, file->data, sizeof(magic));
+    if (magic == kFileMagic) {
+      if (bindFile(file)) return true;
+      quantize(syntheticWeights());
+      return false;
+    }
+
+    FloatWeights f = syntheticWeights();
+    const std::size_t floats = f.w1.size() + f.b1.size() + f.w2.size() + f.b2.size() + f.w3.size() + 1;
+    if ((magic & kLegacyTagMask) == kLegacyTag || file->size != floats * sizeof(float)) {
+      quantize(f);
+      return false;
+    }
+    const unsigned char* at = file->data;
+    for (auto* v : {&f.w1, &f.b1, &f.w2, &f.b2, &f.w3}) {
+      std::memcpy(v->data(), at, v->size() * sizeof(float));
+      at += v->size() * sizeof(float);
+    }
+    std::memcpy(&f.b3, at, sizeof(f.b3));
+    quantize(f);
+    return true;
+  }
+
+  // Checks the header against this build and the payload against its
+  // checksum, then binds the mapping. Rejects without changing anything.
+  bool bindFile(const std::shared_ptr<const mapped_file::File>& file) {
+    FileHeader h{};
+    if (file->size < sizeof(h)) return false;
+    std::memcpy(&h, file->data, sizeof(h));
+    const Layout l = layout();
+    if (h.version != kFileVersion || h.scheme != kQuantScheme || h.ftScale != simd::kFtMax ||
+        h.sparseGroup != simd::kSparseGroup) {
+      return false;
+    }
+    if (h.inputs != cfg.inputs || h.hidden1 != cfg.hidden1 || h.hidden2 != cfg.hidden2 ||
+        h.kingBuckets != kKingBuckets || h.draftUnits != draftUnits()) {
+      return false;
+    }
+    for (const int shift : {h.l2Shift, h.l3Shift, h.draftShift}) {
+      if (shift < 0 || shift > kMaxWeightShift) return false;
+    }
+    if (h.payloadBytes != l.bytes || file->size != sizeof(h) + l.bytes) return false;
+    const unsigned char* payload = file->data + sizeof(h);
+    if (payloadChecksum(payload, l.bytes) != h.checksum) return false;
+    l2Shift = h.l2Shift;
+    l3Shift = h.l3Shift;
+    draftShift = h.draftShift;
+    bindPayload(file, payload);
+    weightsMapped = file->mapped;
+    return true;
+  }
+
+  bool saveQuantized(const std::string& path) const {
+    if (w1.empty() || w2.empty()) return false;
+    const Layout l = layout();
+    std::vector<unsigned char> payload(l.bytes, 0);
+    auto put = [&](std::size_t offset, const void* src, std::size_t bytes) {
+      std::memcpy(payload.data() + offset, src, bytes);
     };
+    put(l.w1, w1.data(), w1.size() * sizeof(std::int16_t));
+    put(l.b1, b1.data(), b1.size() * sizeof(std::int16_t));
+    put(l.w2, w2.data(), w2.size());
+    put(l.b2, b2.data(), b2.size() * sizeof(std::int32_t));
+    put(l.w3, w3.data(), w3.size());
+    put(l.b3, &b3, sizeof(b3));
+    put(l.wd, wd.data(), wd.size());
+    put(l.bd, &bd, sizeof(bd));
+
+    FileHeader h{};
+    h.magic = kFileMagic;
+    h.version = kFileVersion;
+    h.inputs = cfg.inputs;
+    h.hidden1 = cfg.hidden1;
+    h.hidden2 = cfg.hidden2;
+    h.kingBuckets = kKingBuckets;
+    h.scheme = kQuantScheme;
+    h.ftScale = simd::kFtMax;
+    h.l2Shift = l2Shift;
+    h.l3Shift = l3Shift;
+    h.sparseGroup = simd::kSparseGroup;
+    h.draftUnits = draftUnits();
+    h.draftShift = draftShift;
+    h.payloadBytes = l.bytes;
+    h.checksum = payloadChecksum(payload.data(), payload.size());
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    return static_cast<bool>(out);
+  }
+
+  static int piecePlane(char piece) {
+    switch (piece) {
+      case 'P': return 0; case 'N': return 1; case 'B': return 2; case 'R': return 3; case 'Q': return 4; case 'K': return 5;
+      case 'p': return 6; case 'n': return 7; case 'b': return 8; case 'r': return 9; case 'q': return 10; case 'k': return 11;
+      default: return -1;
+    }
+  }
+
+  // `sq` as seen from `perspective`: Black's view is flipped vertically.
+  static int orient(int sq, int perspective) { return perspective == 0 ? sq : sq ^ 56; }
 
-    if (inputSize > 1024) {
-      addThreatSlice(1024, true);
+  static int kingSquare(const std::array<char, 64>& squares, int perspective) {
+    const char king = perspective == 0 ? 'K' : 'k';
+    for (int sq = 0; sq < 64; ++sq) {
+      if (squares[static_cast<std::size_t>(sq)] == king) return sq;
     }
-    if (inputSize > 2048) {
-      addThreatSlice(1024 + 1024, false);
+    return -1;
+  }
+
+  // Buckets by the king's square from its own side: each file pair of the
+  // back rank, then each board half of the second rank and of the rest.
+  static int kingBucket(int kingSq, int perspective) {
+    if (kingSq < 0) return 0;
+    const int sq = orient(kingSq, perspective);
+    const int rank = sq / 8;
+    const int file = sq % 8;
+    if (rank == 0) return file / 2;
+    return (rank == 1 ? 4 : 6) + file / 4;
+  }
+
+  // Feature index of a piece of `plane` on `sq` for `perspective` with its
+  // king in `bucket`, or -1.
+  static int featureIndex(int perspective, int bucket, int plane, int sq, int inputSize) {
+    if (plane < 0) return -1;
+    const bool own = (plane < 6) == (perspective == 0);
+    const int relative = (own ? 0 : 6) + plane % 6;
+    const int idx = bucket * kPlaneInputs + relative * 64 + orient(sq, perspective);
+    return idx < inputSize ? idx : -1;
+  }
+
+  static PieceBitboards pieceBitboards(const std::array<char, 64>& squares) {
+    PieceBitboards bb{};
+    for (int sq = 0; sq < 64; ++sq) {
+      const int plane = piecePlane(squares[static_cast<std::size_t>(sq)]);
+      if (plane >= 0) bb[static_cast<std::size_t>(plane)] |= 1ULL << sq;
     }
+    return bb;
+  }
 
+  static FeatureList extractFeatures(const std::array<char, 64>& squares, bool whiteToMove, int inputSize) {
+    FeatureList f;
+    f.whiteToMove = whiteToMove;
+    for (int p = 0; p < kPerspectives; ++p) {
+      const int bucket = kingBucket(kingSquare(squares, p), p);
+      f.kingBucket[static_cast<std::size_t>(p)] = bucket;
+      auto& active = f.active[static_cast<std::size_t>(p)];
+      for (int sq = 0; sq < 64; ++sq) {
+        const int idx = featureIndex(p, bucket, piecePlane(squares[static_cast<std::size_t>(sq)]), sq, inputSize);
+        if (idx >= 0) active.push_back(static_cast<std::uint16_t>(idx));
+      }
+      std::sort(active.begin(), active.end());
+    }
     return f;
   }
 
-  void initializeAccumulator(Accumulator& acc, const std::vector<float>& input) const {
+  std::uint8_t activate(std::int16_t x) const {
+    return cfg.useSCReLU ? simd::squaredClippedRelu(x) : simd::clippedRelu(x);
+  }
+
+  void activate(const std::int16_t* in, std::uint8_t* out, int n) const {
+    const auto& k = simd::kernels();
+    (cfg.useSCReLU ? k.squaredClippedRelu : k.clippedRelu)(in, out, n);
+  }
+
+  // Output sums are in units of 1 / (kActivationMax << shift): l3Shift for
+  // the network output, draftShift for the draft head.
+  static int toCentipawns(std::int64_t raw, int cpPerUnit, int shift) {
+    const std::int64_t den = static_cast<std::int64_t>(simd::kActivationMax) << shift;
+    const std::int64_t num = raw * cpPerUnit;
+    return static_cast<int>((num >= 0 ? num + den / 2 : num - den / 2) / den);
+  }
+
+  const std::int16_t* row(int idx) const { return &w1[static_cast<std::size_t>(idx) * halfUnits()]; }
+
+  // Pre-activation values of the first n units of one perspective's half:
+  // the bias plus one row per active feature.
+  void refresh(const FeatureList& input, int perspective, std::int16_t* out, int n) const {
+    const auto& k = simd::kernels();
+    std::copy(b1.begin(), b1.begin() + n, out);
+    for (const std::uint16_t idx : input.active[static_cast<std::size_t>(perspective)]) k.addRow(out, row(idx), n);
+  }
+
+  void initializeAccumulator(Accumulator& acc, const FeatureList& input) const {
+    const int half = halfUnits();
     acc.features = input;
-    acc.hidden1.assign(static_cast<std::size_t>(cfg.hidden1), 0.0f);
-    for (int h = 0; h < cfg.hidden1; ++h) {
-      float v = b1[static_cast<std::size_t>(h)];
-      for (int i = 0; i < cfg.inputs; ++i) {
-        if (input[static_cast<std::size_t>(i)] == 0.0f) continue;
-        v += input[static_cast<std::size_t>(i)] * w1[static_cast<std::size_t>(h * cfg.inputs + i)];
-      }
-      acc.hidden1[static_cast<std::size_t>(h)] = v;
-    }
+    acc.hidden1.resize(static_cast<std::size_t>(cfg.hidden1));
+    for (int p = 0; p < kPerspectives; ++p) refresh(input, p, acc.hidden1.data() + p * half, half);
     acc.initialized = true;
   }
 
-  void updateAccumulator(Accumulator& acc, const std::vector<int>& toggledFeatures, const std::vector<float>& newValues) const {
-    if (!acc.initialized || toggledFeatures.size() != newValues.size()) return;
-    for (std::size_t k = 0; k < toggledFeatures.size(); ++k) {
-      const int idx = toggledFeatures[k];
-      if (idx < 0 || idx >= cfg.inputs) continue;
-      const float prev = acc.features[static_cast<std::size_t>(idx)];
-      const float next = newValues[k];
-      const float delta = next - prev;
-      if (delta == 0.0f) continue;
-      acc.features[static_cast<std::size_t>(idx)] = next;
-      for (int h = 0; h < cfg.hidden1; ++h) {
-        acc.hidden1[static_cast<std::size_t>(h)] += delta * w1[static_cast<std::size_t>(h * cfg.inputs + idx)];
+  // Applies the difference between acc.features and `next`; both lists are
+  // sorted, so one merge pass per perspective finds every added and removed
+  // feature. A perspective whose king changed bucket is rebuilt instead.
+  void updateAccumulator(Accumulator& acc, const FeatureList& next) const {
+    if (!acc.initialized) return;
+    const auto& k = simd::kernels();
+    const int half = halfUnits();
+    for (int p = 0; p < kPerspectives; ++p) {
+      const std::size_t ps = static_cast<std::size_t>(p);
+      std::int16_t* out = acc.hidden1.data() + p * half;
+      if (acc.features.kingBucket[ps] != next.kingBucket[ps]) {
+        refresh(next, p, out, half);
+        continue;
+      }
+      const auto& before = acc.features.active[ps];
+      const auto& after = next.active[ps];
+      std::size_t i = 0;
+      std::size_t j = 0;
+      while (i < before.size() || j < after.size()) {
+        if (j == after.size() || (i < before.size() && before[i] < after[j])) {
+          k.subRow(out, row(before[i++]), half);
+        } else if (i == before.size() || after[j] < before[i]) {
+          k.addRow(out, row(after[j++]), half);
+        } else {
+          ++i;
+          ++j;
+        }
       }
     }
+    acc.features = next;
   }
 
-  int evaluateDraft(const std::vector<float>& input) const {
-    if (!enabled || input.empty() || w1.empty()) return 0;
-    const int draft = std::max(64, std::min(cfg.hidden1, cfg.draftHidden1));
-    float out = b3;
-    for (int h = 0; h < draft; ++h) {
-      float v = b1[static_cast<std::size_t>(h)];
-      for (int i = 0; i < cfg.inputs; ++i) {
-        if (input[static_cast<std::size_t>(i)] == 0.0f) continue;
-        v += input[static_cast<std::size_t>(i)] * w1[static_cast<std::size_t>(h * cfg.inputs + i)];
+  // Rebuilds one perspective's half of `acc` for `b` from the cache entry of
+  // its king bucket, which is left holding b.
+  void refreshPerspective(RefreshCache& cache, const board::Board& b, int perspective, Accumulator& acc) const {
+    const auto& k = simd::kernels();
+    const int half = halfUnits();
+    const int bucket = kingBucket(kingSquare(b.squares, perspective), perspective);
+    RefreshEntry& e = cache.entry(*this, bucket, perspective);
+    const PieceBitboards now = pieceBitboards(b.squares);
+    auto& active = acc.features.active[static_cast<std::size_t>(perspective)];
+    active.clear();
+    for (int plane = 0; plane < 12; ++plane) {
+      const std::size_t pl = static_cast<std::size_t>(plane);
+      for (std::uint64_t bits = e.pieces[pl] & ~now[pl]; bits; bits &= bits - 1) {
+        const int idx = featureIndex(perspective, bucket, plane, __builtin_ctzll(bits), cfg.inputs);
+        if (idx >= 0) k.subRow(e.hidden1.data(), row(idx), half);
+      }
+      for (std::uint64_t bits = now[pl] & ~e.pieces[pl]; bits; bits &= bits - 1) {
+        const int idx = featureIndex(perspective, bucket, plane, __builtin_ctzll(bits), cfg.inputs);
+        if (idx >= 0) k.addRow(e.hidden1.data(), row(idx), half);
+      }
+      for (std::uint64_t bits = now[pl]; bits; bits &= bits - 1) {
+        const int idx = featureIndex(perspective, bucket, plane, __builtin_ctzll(bits), cfg.inputs);
+        if (idx >= 0) active.push_back(static_cast<std::uint16_t>(idx));
       }
-      const float a = std::max(0.0f, v);
-      out += a * w3[static_cast<std::size_t>(h % cfg.hidden2)];
     }
-    return static_cast<int>(std::lround(out * 64.0f));
+    std::sort(active.begin(), active.end());
+    e.pieces = now;
+    std::copy(e.hidden1.begin(), e.hidden1.end(), acc.hidden1.begin() + perspective * half);
+    acc.features.kingBucket[static_cast<std::size_t>(perspective)] = bucket;
   }
 
-  int evaluateFromAccumulator(const Accumulator& acc) const {
-    if (!enabled || !acc.initialized || acc.hidden1.empty() || w2.empty()) return 0;
-    std::vector<float> h2(static_cast<std::size_t>(cfg.hidden2), 0.0f);
-    for (int h = 0; h < cfg.hidden2; ++h) {
-      float v = b2[static_cast<std::size_t>(h)];
-      for (int i = 0; i < cfg.hidden1; ++i) {
-        const float relu = std::max(0.0f, acc.hidden1[static_cast<std::size_t>(i)]);
-        v += relu * w2[static_cast<std::size_t>(h * cfg.hidden1 + i)];
+  // Same result as initializeAccumulator(acc, extractFeatures(b...)).
+  void refreshAccumulator(RefreshCache& cache, const board::Board& b, Accumulator& acc) const {
+    acc.hidden1.resize(static_cast<std::size_t>(cfg.hidden1));
+    for (int p = 0; p < kPerspectives; ++p) refreshPerspective(cache, b, p, acc);
+    acc.features.whiteToMove = b.whiteToMove;
+    acc.initialized = true;
+  }
+
+  // Builds `to` from an ancestor accumulator by replaying the dirty pieces of
+  // every ply in between; `b` is the board at `to`. A perspective whose king
+  // ended up in another bucket is refreshed through `cache` instead.
+  void forwardUpdate(RefreshCache& cache, const Accumulator& from, const board::DirtyPieces* dirty, std::size_t plies,
+                     const board::Board& b, Accumulator& to) const {
+    const auto& k = simd::kernels();
+    const int half = halfUnits();
+    to.hidden1 = from.hidden1;
+    to.features = from.features;
+    to.features.whiteToMove = b.whiteToMove;
+    for (int p = 0; p < kPerspectives; ++p) {
+      const int bucket = kingBucket(kingSquare(b.squares, p), p);
+      if (bucket != from.features.kingBucket[static_cast<std::size_t>(p)]) {
+        refreshPerspective(cache, b, p, to);
+        continue;
+      }
+      std::int16_t* out = to.hidden1.data() + p * half;
+      auto& active = to.features.active[static_cast<std::size_t>(p)];
+      for (std::size_t ply = 0; ply < plies; ++ply) {
+        for (int d = 0; d < dirty[ply].count; ++d) {
+          const auto& piece = dirty[ply].pieces[static_cast<std::size_t>(d)];
+          const int plane = piecePlane(piece.piece);
+          const int removed = piece.from >= 0 ? featureIndex(p, bucket, plane, piece.from, cfg.inputs) : -1;
+          const int added = piece.to >= 0 ? featureIndex(p, bucket, plane, piece.to, cfg.inputs) : -1;
+          if (removed >= 0) {
+            k.subRow(out, row(removed), half);
+            active.erase(std::lower_bound(active.begin(), active.end(), static_cast<std::uint16_t>(removed)));
+          }
+          if (added >= 0) {
+            k.addRow(out, row(added), half);
+            active.insert(std::lower_bound(active.begin(), active.end(), static_cast<std::uint16_t>(added)),
+                          static_cast<std::uint16_t>(added));
+          }
+        }
       }
-      h2[static_cast<std::size_t>(h)] = std::max(0.0f, v);
     }
-    float out = b3;
-    for (int i = 0; i < cfg.hidden2; ++i) out += h2[static_cast<std::size_t>(i)] * w3[static_cast<std::size_t>(i)];
-    return static_cast<int>(std::lround(out * 100.0f));
+    to.initialized = true;
   }
 
-  int evaluateAMXKernel(const std::vector<float>& input) const {
-#ifdef __APPLE__
-    // Placeholder for Accelerate/AMX dispatch; keep equivalent semantics for now.
-    Accumulator acc;
-    initializeAccumulator(acc, input);
-    return evaluateFromAccumulator(acc);
-#else
-    Accumulator acc;
-    initializeAccumulator(acc, input);
-    return evaluateFromAccumulator(acc);
-#endif
+  // Per-ply accumulators for one search thread. push() only records the
+  // move's dirty pieces; current() computes the top entry when a node is
+  // actually evaluated, forward from the nearest computed ancestor, so plies
+  // that are never evaluated cost nothing. pop() just drops the entry.
+  struct AccumulatorStack {
+    // Ply i's accumulator and the dirty pieces of the move that led to it;
+    // the dirty pieces sit contiguously so forwardUpdate() reads them in
+    // place.
+    std::vector<Accumulator> accumulators = std::vector<Accumulator>(128);
+    std::vector<board::DirtyPieces> dirty = std::vector<board::DirtyPieces>(128);
+    std::size_t size = 1;
+    RefreshCache cache;
+
+    void reset(const NNUE& net, const board::Board& root) {
+      size = 1;
+      net.refreshAccumulator(cache, root, accumulators[0]);
+    }
+
+    void reset(const Accumulator& root) {
+      size = 1;
+      accumulators[0] = root;
+    }
+
+    void push(const board::DirtyPieces& moved) {
+      if (size == accumulators.size()) {
+        accumulators.resize(accumulators.size() * 2);
+        dirty.resize(accumulators.size());
+      }
+      dirty[size] = moved;
+      accumulators[size++].initialized = false;
+    }
+
+    void pop() {
+      if (size > 1) --size;
+    }
+
+    const Accumulator& root() const { return accumulators[0]; }
+
+    // `b` must be the position after every pushed move.
+    const Accumulator& current(const NNUE& net, const board::Board& b) {
+      const std::size_t top = size - 1;
+      if (accumulators[top].initialized) return accumulators[top];
+      std::size_t base = top;
+      while (base > 0 && !accumulators[base].initialized) --base;
+      // Plies in between stay uncomputed: a king-bucket change there would
+      // need a board the stack never sees.
+      net.forwardUpdate(cache, accumulators[base], dirty.data() + base + 1, top - base, b, accumulators[top]);
+      return accumulators[top];
+    }
+  };
+
+  // Side-to-move perspective first.
+  static int firstPerspective(const FeatureList& f) { return f.whiteToMove ? 0 : 1; }
+
+  // Cheap estimate of evaluateFromAccumulator(acc) for lazy evaluation: the
+  // draft head over a prefix of each half, about 2 * draftUnits() MACs.
+  int evaluateDraft(const Accumulator& acc) const {
+    if (!enabled || !acc.initialized || acc.hidden1.empty() || wd.empty()) return 0;
+    const int half = halfUnits();
+    const int draft = draftUnits();
+    const int first = firstPerspective(acc.features);
+    simd::ScratchArena& arena = simd::scratch();
+    const simd::ScratchArena::Frame frame(arena);
+    std::uint8_t* a = arena.allocate<std::uint8_t>(static_cast<std::size_t>(kPerspectives * draft));
+    activate(acc.hidden1.data() + first * half, a, draft);
+    activate(acc.hidden1.data() + (1 - first) * half, a + draft, draft);
+    std::int32_t out = 0;
+    simd::kernels().affine(a, wd.data(), &bd, &out, kPerspectives * draft, 1);
+    return toCentipawns(out, 100, draftShift);
   }
 
-  int evaluate(const std::vector<float>& input) const {
-    if (!enabled || input.empty() || w1.empty()) return 0;
+  // Side-to-move half, then the other half, activated into a1[hidden1].
+  void activateInputs(const Accumulator& acc, std::uint8_t* a1) const {
+    const int half = halfUnits();
+    const int first = firstPerspective(acc.features);
+    activate(acc.hidden1.data() + first * half, a1, half);
+    activate(acc.hidden1.data() + (1 - first) * half, a1 + half, half);
+  }
 
-    if (cfg.useAMXPath) {
-      // Apple AMX/Accelerate backend hook.
-      return evaluateAMXKernel(input);
+  // Layer 3 from the layer-2 sums s2[hidden2]; a2 is scratch of the same size.
+  int outputLayer(const std::int32_t* s2, std::uint8_t* a2) const {
+    for (int o = 0; o < cfg.hidden2; ++o) {
+      a2[o] = static_cast<std::uint8_t>(std::clamp(s2[o] >> l2Shift, 0, simd::kActivationMax));
     }
+    std::int32_t out = 0;
+    simd::kernels().affine(a2, w3.data(), &b3, &out, cfg.hidden2, 1);
+    return toCentipawns(out, 100, l3Shift);
+  }
 
-    std::vector<float> h1(static_cast<std::size_t>(cfg.hidden1), 0.0f);
-    std::vector<float> h2(static_cast<std::size_t>(cfg.hidden2), 0.0f);
+  int evaluateFromAccumulator(const Accumulator& acc) const {
+    if (!enabled || !acc.initialized || acc.hidden1.empty() || w2.empty()) return 0;
+    simd::ScratchArena& arena = simd::scratch();
+    const simd::ScratchArena::Frame frame(arena);
+    std::uint8_t* a1 = arena.allocate<std::uint8_t>(static_cast<std::size_t>(cfg.hidden1));
+    std::int32_t* s2 = arena.allocate<std::int32_t>(static_cast<std::size_t>(cfg.hidden2));
+    std::uint8_t* a2 = arena.allocate<std::uint8_t>(static_cast<std::size_t>(cfg.hidden2));
+    activateInputs(acc, a1);
+    simd::kernels().sparseAffine(a1, w2.data(), b2.data(), s2, cfg.hidden1, cfg.hidden2);
+    return outputLayer(s2, a2);
+  }
 
-    for (int h = 0; h < cfg.hidden1; ++h) {
-      float acc = b1[static_cast<std::size_t>(h)];
-      for (int i = 0; i < cfg.inputs; ++i) acc += input[static_cast<std::size_t>(i)] * w1[static_cast<std::size_t>(h * cfg.inputs + i)];
-      const float relu = std::max(0.0f, acc);
-      if (cfg.useSCReLU) {
-        const float clipped = std::min(1.0f, relu);
-        h1[static_cast<std::size_t>(h)] = clipped * clipped;
+  // Upper layers for n accumulators at once; out[i] matches
+  // evaluateFromAccumulator(*accs[i]). Layer 2 is one sparseAffineBatch, so
+  // w2 is streamed once per block of positions rather than once per position.
+  void evaluateAccumulators(const Accumulator* const* accs, std::size_t n, int* out) const {
+    if (n == 0) return;
+    if (!enabled || w2.empty()) {
+      std::fill(out, out + n, 0);
+      return;
+    }
+    const std::size_t h1 = static_cast<std::size_t>(cfg.hidden1);
+    const std::size_t h2 = static_cast<std::size_t>(cfg.hidden2);
+    simd::ScratchArena& arena = simd::scratch();
+    const simd::ScratchArena::Frame frame(arena);
+    std::uint8_t* a1 = arena.allocate<std::uint8_t>(h1 * n);
+    std::int32_t* s2 = arena.allocate<std::int32_t>(h2 * n);
+    std::uint8_t* a2 = arena.allocate<std::uint8_t>(h2);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (accs[i]->initialized && !accs[i]->hidden1.empty()) {
+        activateInputs(*accs[i], &a1[i * h1]);
       } else {
-        h1[static_cast<std::size_t>(h)] = relu;
+        std::fill_n(&a1[i * h1], h1, std::uint8_t{0});
       }
     }
-    for (int h = 0; h < cfg.hidden2; ++h) {
-      float acc = b2[static_cast<std::size_t>(h)];
-      for (int i = 0; i < cfg.hidden1; ++i) acc += h1[static_cast<std::size_t>(i)] * w2[static_cast<std::size_t>(h * cfg.hidden1 + i)];
-      h2[static_cast<std::size_t>(h)] = std::max(0.0f, acc);
+    simd::kernels().sparseAffineBatch(a1, w2.data(), b2.data(), s2, cfg.hidden1, cfg.hidden2, static_cast<int>(n));
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = accs[i]->initialized && !accs[i]->hidden1.empty() ? outputLayer(&s2[i * h2], a2) : 0;
     }
+  }
 
-    float out = b3;
-    for (int i = 0; i < cfg.hidden2; ++i) out += h2[static_cast<std::size_t>(i)] * w3[static_cast<std::size_t>(i)];
-    return static_cast<int>(std::lround(out * 100.0f));
+  int evaluate(const FeatureList& input) const {
+    if (!enabled || input.empty() || w1.empty()) return 0;
+    // Rebuilt from scratch on every call; only its capacity is reused.
+    thread_local Accumulator acc;
+    initializeAccumulator(acc, input);
+    return evaluateFromAccumulator(acc);
   }
 
-  int evaluateMiniQSearch(const std::vector<float>& input) const {
-    if (!enabled || input.empty()) return 0;
-    return evaluateDraft(input);
+  // Builds each position's accumulator, then runs the upper layers through
+  // evaluateAccumulators() kBatchPositions at a time. Results match evaluate().
+  static constexpr std::size_t kBatchPositions = 64;
+  void evaluateBatch(const board::Board* positions, std::size_t count, int* out) const {
+    if (count == 0) return;
+    if (!enabled || w1.empty()) {
+      std::fill(out, out + count, 0);
+      return;
+    }
+    std::vector<Accumulator> accs(std::min(count, kBatchPositions));
+    std::vector<const Accumulator*> batch(accs.size());
+    for (std::size_t begin = 0; begin < count; begin += kBatchPositions) {
+      const std::size_t n = std::min(kBatchPositions, count - begin);
+      for (std::size_t i = 0; i < n; ++i) {
+        const board::Board& b = positions[begin + i];
+        initializeAccumulator(accs[i], extractFeatures(b.squares, b.whiteToMove, cfg.inputs));
+        batch[i] = &accs[i];
+      }
+      evaluateAccumulators(batch.data(), n, out + begin);
+    }
   }
 
+  int evaluateMiniQSearch(const Accumulator& acc) const { return evaluateDraft(acc); }
+
+  // Nudges the first few feature-transformer biases; steps smaller than one
+  // quantization unit are dropped.
   void distillStrategicHint(float policyActivation, float valueActivation) {
     if (w1.empty() || b1.empty()) return;
     const float blend = (policyActivation * 0.2f) + (valueActivation * 0.8f);
-    const int taps = std::min(16, cfg.hidden1);
+    const int step = static_cast<int>(std::lround(blend * 0.0005f * static_cast<float>(simd::kFtMax)));
+    if (step == 0) return;
+    const int taps = std::min(16, static_cast<int>(b1.size()));
     for (int h = 0; h < taps; ++h) {
-      b1[static_cast<std::size_t>(h)] += blend * 0.0005f;
+      auto& b = b1[static_cast<std::size_t>(h)];
+      b = static_cast<std::int16_t>(std::clamp(b + step, -32767, 32767));
     }
   }
 };
@@ -542,15 +1058,350 @@ struct StrategyRouterInput {
 
 struct StrategyOutput {
   int valueCp = 0;
+  // Every policy logit, or with policyMoves set, one per listed index.
   std::vector<float> policy;
+  std::vector<std::uint16_t> policyMoves;
   std::array<float, 3> wdl{{0.33f, 0.34f, 0.33f}};  // win/draw/loss
   std::array<float, 2> tacticalThreat{{0.0f, 0.0f}};
   std::array<float, 2> kingSafety{{0.0f, 0.0f}};
   std::array<float, 2> mobility{{0.0f, 0.0f}};
   std::array<float, 3> expertMix{{0.0f, 0.0f, 0.0f}};
+  float policyFloor = 0.0f;
+
+  // Back to the defaults, keeping the policy storage for the next pass.
+  void reset() {
+    valueCp = 0;
+    policy.clear();
+    policyMoves.clear();
+    wdl = {0.33f, 0.34f, 0.33f};
+    tacticalThreat = {0.0f, 0.0f};
+    kingSafety = {0.0f, 0.0f};
+    mobility = {0.0f, 0.0f};
+    expertMix = {0.0f, 0.0f, 0.0f};
+    policyFloor = 0.0f;
+  }
+
+  // Logit of policy output `index`; policyFloor if it was not computed.
+  float policyLogit(int index) const {
+    if (policyMoves.empty()) {
+      return index >= 0 && index < static_cast<int>(policy.size()) ? policy[static_cast<std::size_t>(index)] : policyFloor;
+    }
+    for (std::size_t k = 0; k < policyMoves.size(); ++k) {
+      if (policyMoves[k] == index) return policy[k];
+    }
+    return policyFloor;
+  }
+};
+
+// Heads StrategyNet::evaluate computes; skipped ones keep their defaults.
+enum StrategyHead : unsigned {
+  kStrategyValue = 1u << 0,
+  kStrategyPolicy = 1u << 1,
+  kStrategyWdl = 1u << 2,
+  kStrategyTactical = 1u << 3,
+  kStrategyKingSafety = 1u << 4,
+  kStrategyMobility = 1u << 5,
+  kStrategyAllHeads = (1u << 6) - 1,
+};
+
+struct StrategyQuery {
+  unsigned heads = kStrategyAllHeads;
+  // With legalMoves set, only their from * 64 + to policy logits are
+  // computed, in list order.
+  const std::vector<movegen::Move>* legalMoves = nullptr;
+};
+
+// One position of a StrategyNet::evaluateBatch call.
+struct StrategyJob {
+  const std::vector<float>* planes = nullptr;
+  GamePhase phase = GamePhase::Middlegame;
+  StrategyQuery query;
+};
+
+// Worker threads for splitting one large evaluation. run(n, task) calls
+// task(i) for every i < n on the workers and the caller and returns once all
+// are done. Tasks write disjoint outputs, so results do not depend on the
+// thread count or on scheduling. A run() issued from inside a task, or while
+// another thread's run() is in progress, executes serially on its caller.
+class TaskPool {
+ public:
+  // `threads` counts the caller, so 1 starts no workers.
+  explicit TaskPool(int threads) {
+    for (int t = 1; t < threads; ++t) workers_.emplace_back([this] { work(); });
+  }
+
+  ~TaskPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker.join();
+  }
+
+  TaskPool(const TaskPool&) = delete;
+  TaskPool& operator=(const TaskPool&) = delete;
+
+  int threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // task is any callable taking the index; it is not copied.
+  template <typename Task>
+  void run(std::size_t n, const Task& task) {
+    std::unique_lock<std::mutex> exclusive(runMutex_, std::try_to_lock);
+    if (workers_.empty() || n < 2 || insideTask() || !exclusive.owns_lock()) {
+      for (std::size_t i = 0; i < n; ++i) task(i);
+      return;
+    }
+    const Erased erased{&task, [](const void* t, std::size_t i) { (*static_cast<const Task*>(t))(i); }};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = &erased;
+      count_ = n;
+      next_.store(0, std::memory_order_relaxed);
+      ++generation_;
+    }
+    wake_.notify_all();
+    drain(erased, n);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return finished_ == n && busy_ == 0; });
+    finished_ = 0;
+    task_ = nullptr;
+  }
+
+ private:
+  struct Erased {
+    const void* task;
+    void (*call)(const void* task, std::size_t index);
+  };
+
+  static bool& insideTask() {
+    thread_local bool inside = false;
+    return inside;
+  }
+
+  // Claims and runs tasks until none are left; returns how many ran.
+  std::size_t drain(const Erased& task, std::size_t n) {
+    insideTask() = true;
+    std::size_t ran = 0;
+    for (std::size_t i = next_.fetch_add(1); i < n; i = next_.fetch_add(1)) {
+      task.call(task.task, i);
+      ++ran;
+    }
+    insideTask() = false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ += ran;
+    return ran;
+  }
+
+  void work() {
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      wake_.wait(lock, [&] { return stopping_ || (task_ && generation_ != seen); });
+      if (stopping_) return;
+      seen = generation_;
+      const auto* task = task_;
+      const std::size_t n = count_;
+      ++busy_;
+      lock.unlock();
+      drain(*task, n);
+      lock.lock();
+      --busy_;
+      done_.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex runMutex_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const Erased* task_ = nullptr;
+  std::size_t count_ = 0;
+  std::atomic<std::size_t> next_{0};
+  std::size_t finished_ = 0;
+  int busy_ = 0;
+  std::uint64_t generation_ = 0;
+  bool stopping_ = false;
+};
+
+// Inputs of a QuantizedLinear: non-negative (post-ReLU) values scaled per
+// call so the largest maps to simd::kActivationMax.
+struct QuantizedVector {
+  std::uint8_t* q = nullptr;  // caller-owned, at least n bytes
+  float scale = 0.0f;         // value = q * scale
+
+  void set(const float* x, int n) {
+    float maxValue = 0.0f;
+    for (int i = 0; i < n; ++i) maxValue = std::max(maxValue, x[i]);
+    scale = maxValue / static_cast<float>(simd::kActivationMax);
+    const float inv = maxValue > 0.0f ? 1.0f / scale : 0.0f;
+    for (int i = 0; i < n; ++i) {
+      q[static_cast<std::size_t>(i)] =
+          static_cast<std::uint8_t>(std::min<long>(simd::kActivationMax, std::lround(std::max(0.0f, x[i]) * inv)));
+    }
+  }
 };
 
+// int8 matrix with one float scale per output row, stored output-major so
+// every output is one contiguous simd::Kernels::affine dot product. The
+// packed form (w, then rowScale on the next 64-byte boundary) is also the
+// on-disk form, so a mapped file section is used in place.
+struct QuantizedLinear {
+  int inputs = 0;
+  int outputs = 0;
+  ConstSpan<std::int8_t> w;  // [o * inputs + i]
+  ConstSpan<float> rowScale;
+  std::vector<std::int32_t> zeros;  // affine() bias
+  std::shared_ptr<const void> storage;  // owns what w and rowScale view
+
+  static std::size_t scaleOffset(int outs, int ins) {
+    return (static_cast<std::size_t>(outs) * ins + 63) / 64 * 64;
+  }
+  static std::size_t packedBytes(int outs, int ins) {
+    return (scaleOffset(outs, ins) + static_cast<std::size_t>(outs) * sizeof(float) + 63) / 64 * 64;
+  }
+
+  // Views packedBytes(outs, ins) bytes at `packed`, which `owner` keeps alive.
+  void bind(std::shared_ptr<const void> owner, const unsigned char* packed, int outs, int ins) {
+    inputs = ins;
+    outputs = outs;
+    w = {reinterpret_cast<const std::int8_t*>(packed), static_cast<std::size_t>(outs) * ins};
+    rowScale = {reinterpret_cast<const float*>(packed + scaleOffset(outs, ins)), static_cast<std::size_t>(outs)};
+    zeros.assign(static_cast<std::size_t>(outs), 0);
+    storage = std::move(owner);
+  }
+
+  // Element (o, i) of the source is src[o * outStride + i * inStride], so
+  // input-major float layouts are transposed here, once.
+  void pack(const float* src, int outs, int ins, std::size_t outStride, std::size_t inStride) {
+    auto buffer = std::make_shared<simd::AlignedVector<unsigned char>>(packedBytes(outs, ins), 0);
+    auto* q = reinterpret_cast<std::int8_t*>(buffer->data());
+    auto* scales = reinterpret_cast<float*>(buffer->data() + scaleOffset(outs, ins));
+    for (int o = 0; o < outs; ++o) {
+      const float* row = src + static_cast<std::size_t>(o) * outStride;
+      float maxAbs = 0.0f;
+      for (int i = 0; i < ins; ++i) maxAbs = std::max(maxAbs, std::fabs(row[static_cast<std::size_t>(i) * inStride]));
+      scales[o] = 0.0f;
+      if (maxAbs == 0.0f) continue;
+      const float scale = maxAbs / 127.0f;
+      scales[o] = scale;
+      std::int8_t* dst = &q[static_cast<std::size_t>(o) * ins];
+      for (int i = 0; i < ins; ++i) {
+        dst[i] = static_cast<std::int8_t>(std::clamp<long>(std::lround(row[static_cast<std::size_t>(i) * inStride] / scale), -127, 127));
+      }
+    }
+    const unsigned char* packed = buffer->data();
+    bind(std::move(buffer), packed, outs, ins);
+  }
+
+  // The packedBytes() that bind() reads back.
+  void writePacked(unsigned char* dst) const {
+    std::memcpy(dst, w.data(), w.size());
+    std::memcpy(dst + scaleOffset(outputs, inputs), rowScale.data(), rowScale.size() * sizeof(float));
+  }
+
+  // out[o] = sum_i x[i] * W(o, i); sums has `outputs` entries of scratch.
+  void apply(const QuantizedVector& x, float* out, std::int32_t* sums, TaskPool* pool = nullptr) const {
+    if (pool) {
+      applyBatch(&x, 1, out, sums, pool);
+      return;
+    }
+    simd::kernels().affine(x.q, w.data(), zeros.data(), sums, inputs, outputs);
+    for (int o = 0; o < outputs; ++o) {
+      out[o] = static_cast<float>(sums[o]) * x.scale * rowScale[static_cast<std::size_t>(o)];
+    }
+  }
+
+  // apply() for n inputs; out holds n rows of `outputs`. The weights are
+  // walked in blocks that stay in L1 while every input passes over them;
+  // with a pool the blocks are shared out across its threads.
+  void applyBatch(const QuantizedVector* xs, std::size_t n, float* out, std::int32_t* sums,
+                  TaskPool* pool = nullptr) const {
+    constexpr int kRowBlock = 32;
+    const auto affine = simd::kernels().affine;
+    auto rowBlock = [&](std::size_t blockIndex) {
+      const int o0 = static_cast<int>(blockIndex) * kRowBlock;
+      const int rows = std::min(kRowBlock, outputs - o0);
+      const std::int8_t* block = &w[static_cast<std::size_t>(o0) * inputs];
+      std::int32_t* blockSums = sums + o0;
+      for (std::size_t b = 0; b < n; ++b) {
+        affine(xs[b].q, block, &zeros[static_cast<std::size_t>(o0)], blockSums, inputs, rows);
+        float* dst = out + b * static_cast<std::size_t>(outputs) + o0;
+        for (int r = 0; r < rows; ++r) {
+          dst[r] = static_cast<float>(blockSums[r]) * xs[b].scale * rowScale[static_cast<std::size_t>(o0 + r)];
+        }
+      }
+    };
+    const std::size_t blocks = static_cast<std::size_t>((outputs + kRowBlock - 1) / kRowBlock);
+    if (pool) {
+      pool->run(blocks, rowBlock);
+    } else {
+      for (std::size_t i = 0; i < blocks; ++i) rowBlock(i);
+    }
+  }
+
+  // apply() for the listed outputs only: out[k] is output rows[k].
+  void applyRows(const QuantizedVector& x, const std::uint16_t* rows, std::size_t n, float* out) const {
+    const auto affine = simd::kernels().affine;
+    for (std::size_t k = 0; k < n; ++k) {
+      std::int32_t sum = 0;
+      affine(x.q, &w[static_cast<std::size_t>(rows[k]) * inputs], zeros.data(), &sum, inputs, 1);
+      out[k] = static_cast<float>(sum) * x.scale * rowScale[rows[k]];
+    }
+  }
+};
+
+// Wall time of each StrategyNet::evaluate stage, accumulated across calls.
+struct StrategyTimings {
+  std::chrono::nanoseconds stem{0};
+  std::chrono::nanoseconds attention{0};
+  std::chrono::nanoseconds experts{0};
+  std::chrono::nanoseconds heads{0};
+};
+
+// StrategyNet file: a FileHeader whose index locates five sections, each on
+// a 64-byte boundary and built from QuantizedLinear packed matrices:
+//   core      stem, tokenProjection, valueHead and valueBias as floats, then
+//             the fused QKV matrix of every attention layer
+//   expert e  its residual blocks, then its strategy-bias head
+//   policy    the policy head
+// load() reads only the core. An expert is bound the first time the router
+// gives it weight and the policy head the first time a policy is asked for,
+// so a mapped file pages in only what the game uses. Files without the
+// magic are the legacy float dump, mapped the same way and packed section
+// by section; a missing file gives synthetic weights, also built lazily.
 struct StrategyNet {
+  static constexpr std::uint32_t kFileMagic = 0x54454e53u;  // "SNET"
+  static constexpr std::uint32_t kFileVersion = 1;
+  enum Section : int { kCoreSection = 0, kExpertSection = 1, kPolicySection = 4, kSectionCount = 5 };
+
+  struct SectionEntry {
+    std::uint64_t offset;  // from the start of the file
+    std::uint64_t bytes;
+    std::uint64_t checksum;  // NNUE::payloadChecksum()
+    std::uint64_t reserved;
+  };
+
+  struct FileHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::int32_t planes;
+    std::int32_t channels;
+    std::int32_t transformerLayers;
+    std::int32_t residualBlocks;
+    std::int32_t policyOutputs;
+    std::uint32_t sectionCount;
+    std::array<SectionEntry, kSectionCount> sections;
+  };
+  static_assert(sizeof(FileHeader) % 64 == 0, "sections must start aligned");
+
+  // Float offsets of each tensor in a legacy float file.
+  struct FloatLayout {
+    std::size_t stem, tokenProjection, attentionQ, attentionK, attentionV, experts, strategyBias, valueHead,
+        valueBias, policy, floats;
+  };
+
   bool enabled = true;
   std::string weightsPath = "strategy_large.nn";
   StrategyConfig cfg{};
@@ -561,19 +1412,26 @@ struct StrategyNet {
   }};
   std::vector<float> stem;
   std::vector<float> tokenProjection;
-  std::vector<float> attentionQ;
-  std::vector<float> attentionK;
-  std::vector<float> attentionV;
-  std::array<std::vector<float>, 3> expertBlocks;  // opening/mid/end experts
-  std::array<std::vector<float>, 3> strategyBiasHead;  // long-term plan vectors
   std::vector<float> valueHead;
-  std::array<float, 3> wdlHead{};
+  std::array<float, 3> wdlHead{{0.12f, 0.05f, -0.12f}};
   std::array<float, 3> routerBias{{0.20f, 0.30f, 0.20f}};
   float valueBias = 0.0f;
-  std::vector<float> policyHead;
-  std::array<float, 2> tacticalHead{};
-  std::array<float, 2> kingSafetyHead{};
-  std::array<float, 2> mobilityHead{};
+  std::array<float, 2> tacticalHead{{0.15f, -0.15f}};
+  std::array<float, 2> kingSafetyHead{{0.12f, -0.12f}};
+  std::array<float, 2> mobilityHead{{0.08f, -0.08f}};
+
+  // The matrix layers, int8 and output-major. Q, K and V of a layer are one
+  // matrix of 3 * channels outputs. The expert and policy matrices stay
+  // empty until require() binds their section.
+  std::vector<QuantizedLinear> attentionQKV;
+  mutable std::array<std::vector<QuantizedLinear>, 3> expertLinear;
+  mutable std::array<QuantizedLinear, 3> strategyBiasLinear;
+  mutable QuantizedLinear policyLinear;
+  // Optional (not owned): splits the attention, expert and dense policy
+  // matrices by row blocks across its threads. Outputs are unchanged.
+  TaskPool* pool = nullptr;
+  // The sections are views of a mapped StrategyNet file.
+  bool weightsMapped = false;
 
   std::size_t parameterCount() const {
     const std::size_t stemParams = static_cast<std::size_t>(cfg.planes) * cfg.channels;
@@ -585,64 +1443,123 @@ struct StrategyNet {
     return stemParams + tokenParams + attentionParams + expertParams + strategyBiasParams + headParams;
   }
 
-  void initializeWeights() {
-    stem.assign(static_cast<std::size_t>(cfg.planes * cfg.channels), 0.001f);
-    tokenProjection.assign(static_cast<std::size_t>(64 * cfg.channels), 0.0008f);
-    attentionQ.assign(static_cast<std::size_t>(cfg.transformerLayers * cfg.channels * cfg.channels), 0.0f);
-    attentionK.assign(static_cast<std::size_t>(cfg.transformerLayers * cfg.channels * cfg.channels), 0.0f);
-    attentionV.assign(static_cast<std::size_t>(cfg.transformerLayers * cfg.channels * cfg.channels), 0.0f);
-    for (auto& expert : expertBlocks) {
-      expert.assign(static_cast<std::size_t>(cfg.residualBlocks * cfg.channels * cfg.channels), 0.0f);
-    }
-    for (auto& strategyBias : strategyBiasHead) {
-      strategyBias.assign(static_cast<std::size_t>(cfg.channels * cfg.policyOutputs), 0.0f);
+  // Maps `path` and reads the core section. A StrategyNet file must match
+  // the configured dimensions and its index and core checksum must hold;
+  // otherwise the synthetic weights are used and false is returned.
+  bool load(const std::string& path) {
+    weightsPath = path;
+    enabled = true;
+    file_ = mapped_file::open(path);
+    sectioned_ = false;
+    bool ok = true;
+    if (file_ && file_->size >= sizeof(std::uint32_t)) {
+      std::uint32_t magic = 0;
+      std::memcpy(&magic, file_->data, sizeof(magic));
+      if (magic == kFileMagic) {
+        sectioned_ = readHeader();
+        ok = sectioned_;
+        if (!ok) file_.reset();
+      }
     }
-    valueHead.assign(static_cast<std::size_t>(cfg.channels), 0.0f);
-    policyHead.assign(static_cast<std::size_t>(cfg.channels * cfg.policyOutputs), 0.0f);
+    for (auto& resident : resident_) resident.store(false, std::memory_order_relaxed);
+    for (auto& expert : expertLinear) expert.clear();
+    strategyBiasLinear = {};
+    policyLinear = QuantizedLinear{};
+    rejected_.store(0, std::memory_order_relaxed);
+    loadCore();
+    resident_[kCoreSection].store(true, std::memory_order_release);
+    weightsMapped = sectioned_ && file_->mapped;
+    return ok;
+  }
 
-    for (std::size_t i = 0; i < attentionQ.size(); ++i) attentionQ[i] = static_cast<float>((static_cast<int>(i % 29) - 14) * 0.0003f);
-    for (std::size_t i = 0; i < attentionK.size(); ++i) attentionK[i] = static_cast<float>((static_cast<int>(i % 31) - 15) * 0.0003f);
-    for (std::size_t i = 0; i < attentionV.size(); ++i) attentionV[i] = static_cast<float>((static_cast<int>(i % 19) - 9) * 0.0004f);
-    for (int e = 0; e < 3; ++e) {
-      for (std::size_t i = 0; i < expertBlocks[static_cast<std::size_t>(e)].size(); ++i) {
-        expertBlocks[static_cast<std::size_t>(e)][i] = static_cast<float>((static_cast<int>((i + e) % 23) - 11) * 0.0005f);
-      }
-      for (std::size_t i = 0; i < strategyBiasHead[static_cast<std::size_t>(e)].size(); ++i) {
-        strategyBiasHead[static_cast<std::size_t>(e)][i] = static_cast<float>((static_cast<int>((i + 2 * e) % 37) - 18) * 0.0008f);
-      }
+  // Writes every section as a StrategyNet file, binding any not yet used.
+  bool save(const std::string& path) const {
+    if (stem.empty()) return false;
+    for (int section = kExpertSection; section < kSectionCount; ++section) require(section);
+    FileHeader h{};
+    h.magic = kFileMagic;
+    h.version = kFileVersion;
+    h.planes = cfg.planes;
+    h.channels = cfg.channels;
+    h.transformerLayers = cfg.transformerLayers;
+    h.residualBlocks = cfg.residualBlocks;
+    h.policyOutputs = cfg.policyOutputs;
+    h.sectionCount = kSectionCount;
+    std::vector<unsigned char> payload;
+    for (int section = 0; section < kSectionCount; ++section) {
+      const std::size_t at = payload.size();
+      payload.resize(at + sectionBytes(section), 0);
+      writeSection(section, payload.data() + at);
+      h.sections[static_cast<std::size_t>(section)] = {sizeof(h) + at, sectionBytes(section),
+                                                       NNUE::payloadChecksum(payload.data() + at, sectionBytes(section)), 0};
     }
-    for (std::size_t i = 0; i < valueHead.size(); ++i) valueHead[i] = static_cast<float>((static_cast<int>(i % 13) - 6) * 0.01f);
-    for (std::size_t i = 0; i < policyHead.size(); ++i) policyHead[i] = static_cast<float>((static_cast<int>(i % 17) - 8) * 0.0015f);
-    wdlHead = {0.12f, 0.05f, -0.12f};
-    tacticalHead = {0.15f, -0.15f};
-    kingSafetyHead = {0.12f, -0.12f};
-    mobilityHead = {0.08f, -0.08f};
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    return static_cast<bool>(out);
   }
 
-  bool load(const std::string& path) {
-    weightsPath = path;
-    initializeWeights();
+  // Makes `section` usable. Cheap once it is; the first caller binds it
+  // while any other waits, from whichever thread gets there first.
+  void require(int section) const {
+    std::atomic<bool>& resident = resident_[static_cast<std::size_t>(section)];
+    if (resident.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(sectionMutex_);
+    if (resident.load(std::memory_order_relaxed)) return;
+    bindSection(section);
+    resident.store(true, std::memory_order_release);
+  }
 
-    std::ifstream in(path, std::ios::binary);
-    if (in) {
-      in.read(reinterpret_cast<char*>(stem.data()), static_cast<std::streamsize>(stem.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(tokenProjection.data()), static_cast<std::streamsize>(tokenProjection.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(attentionQ.data()), static_cast<std::streamsize>(attentionQ.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(attentionK.data()), static_cast<std::streamsize>(attentionK.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(attentionV.data()), static_cast<std::streamsize>(attentionV.size() * sizeof(float)));
-      for (auto& expert : expertBlocks) {
-        in.read(reinterpret_cast<char*>(expert.data()), static_cast<std::streamsize>(expert.size() * sizeof(float)));
-      }
-      for (auto& strategyBias : strategyBiasHead) {
-        in.read(reinterpret_cast<char*>(strategyBias.data()), static_cast<std::streamsize>(strategyBias.size() * sizeof(float)));
-      }
-      in.read(reinterpret_cast<char*>(valueHead.data()), static_cast<std::streamsize>(valueHead.size() * sizeof(float)));
-      in.read(reinterpret_cast<char*>(&valueBias), static_cast<std::streamsize>(sizeof(valueBias)));
-      in.read(reinterpret_cast<char*>(policyHead.data()), static_cast<std::streamsize>(policyHead.size() * sizeof(float)));
+  bool resident(int section) const { return resident_[static_cast<std::size_t>(section)].load(std::memory_order_acquire); }
+  // Sections of a StrategyNet file that failed their checksum when first
+  // used; they run on synthetic weights.
+  int rejectedSections() const { return rejected_.load(std::memory_order_relaxed); }
+
+  std::size_t sectionBytes(int section) const {
+    const int c = cfg.channels;
+    auto aligned = [](std::size_t bytes) { return (bytes + 63) / 64 * 64; };
+    if (section == kCoreSection) {
+      const std::size_t floats = aligned(static_cast<std::size_t>(cfg.planes) * c * sizeof(float)) +
+                                 aligned(static_cast<std::size_t>(64) * c * sizeof(float)) +
+                                 aligned(static_cast<std::size_t>(c) * sizeof(float)) + aligned(sizeof(float));
+      return floats + static_cast<std::size_t>(cfg.transformerLayers) * QuantizedLinear::packedBytes(3 * c, c);
     }
+    const std::size_t head = QuantizedLinear::packedBytes(cfg.policyOutputs, c);
+    if (section == kPolicySection) return head;
+    return static_cast<std::size_t>(cfg.residualBlocks) * QuantizedLinear::packedBytes(c, c) + head;
+  }
 
-    enabled = true;
-    return true;
+  FloatLayout floatLayout() const {
+    const std::size_t c = static_cast<std::size_t>(cfg.channels);
+    const std::size_t attention = static_cast<std::size_t>(cfg.transformerLayers) * c * c;
+    const std::size_t head = c * static_cast<std::size_t>(cfg.policyOutputs);
+    FloatLayout l{};
+    l.stem = 0;
+    l.tokenProjection = l.stem + static_cast<std::size_t>(cfg.planes) * c;
+    l.attentionQ = l.tokenProjection + 64 * c;
+    l.attentionK = l.attentionQ + attention;
+    l.attentionV = l.attentionK + attention;
+    l.experts = l.attentionV + attention;
+    l.strategyBias = l.experts + 3 * static_cast<std::size_t>(cfg.residualBlocks) * c * c;
+    l.valueHead = l.strategyBias + 3 * head;
+    l.valueBias = l.valueHead + c;
+    l.policy = l.valueBias + 1;
+    l.floats = l.policy + head;
+    return l;
+  }
+
+  int policyIndex(const movegen::Move& m) const { return (m.from * 64 + m.to) % cfg.policyOutputs; }
+
+  // Piece-letter planes of a board, as search and losslearn feed them.
+  static std::vector<float> boardPlanes(const std::array<char, 64>& squares, int planes) {
+    std::vector<float> out(static_cast<std::size_t>(planes), 0.0f);
+    for (const char piece : squares) {
+      if (piece == '.') continue;
+      const int idx = std::min(planes - 1, std::tolower(static_cast<unsigned char>(piece)) - 'a');
+      if (idx >= 0 && idx < planes) out[static_cast<std::size_t>(idx)] += 1.0f / 8.0f;
+    }
+    return out;
   }
 
   StrategyRouterInput computeRouterInput(const std::vector<float>& planes) const {
@@ -693,123 +1610,669 @@ struct StrategyNet {
     return sparse;
   }
 
-  StrategyOutput evaluate(const std::vector<float>& planes, GamePhase phase = GamePhase::Middlegame) const {
+  // The matrix layers run on the packed int8 copies; every input they see
+  // is post-ReLU. `timings`, if given, accumulates the time of each stage.
+  StrategyOutput evaluate(const std::vector<float>& planes, GamePhase phase = GamePhase::Middlegame,
+                          const StrategyQuery& query = StrategyQuery{}, StrategyTimings* timings = nullptr) const {
     StrategyOutput out;
-    out.policy.assign(static_cast<std::size_t>(cfg.policyOutputs), 0.0f);
-    if (!enabled || planes.empty() || stem.empty()) return out;
+    evaluateInto(planes, phase, query, out, timings);
+    return out;
+  }
 
-    std::vector<float> state(static_cast<std::size_t>(cfg.channels), 0.0f);
-    for (int c = 0; c < cfg.channels; ++c) {
-      float acc = 0.0f;
-      for (int p = 0; p < cfg.planes; ++p) {
-        const std::size_t wIdx = static_cast<std::size_t>(p * cfg.channels + c);
-        acc += planes[static_cast<std::size_t>(p)] * stem[wIdx];
-      }
-      state[static_cast<std::size_t>(c)] = std::max(0.0f, acc);
-    }
-
-    for (int layer = 0; layer < cfg.transformerLayers; ++layer) {
-      std::vector<float> q(static_cast<std::size_t>(cfg.channels), 0.0f);
-      std::vector<float> k(static_cast<std::size_t>(cfg.channels), 0.0f);
-      std::vector<float> v(static_cast<std::size_t>(cfg.channels), 0.0f);
-      const std::size_t attnOffset = static_cast<std::size_t>(layer * cfg.channels * cfg.channels);
-      for (int c = 0; c < cfg.channels; ++c) {
-        for (int i = 0; i < cfg.channels; ++i) {
-          const float s = state[static_cast<std::size_t>(i)];
-          q[static_cast<std::size_t>(c)] += s * attentionQ[attnOffset + static_cast<std::size_t>(c * cfg.channels + i)];
-          k[static_cast<std::size_t>(c)] += s * attentionK[attnOffset + static_cast<std::size_t>(c * cfg.channels + i)];
-          v[static_cast<std::size_t>(c)] += s * attentionV[attnOffset + static_cast<std::size_t>(c * cfg.channels + i)];
+  // evaluate() into a caller-owned output. Temporaries come from the
+  // thread's simd::scratch() arena, so once `out` and the arena have grown
+  // to size a pass performs no heap allocation.
+  void evaluateInto(const std::vector<float>& planes, GamePhase phase, const StrategyQuery& query,
+                    StrategyOutput& out, StrategyTimings* timings = nullptr) const {
+    const StrategyJob job{&planes, phase, query};
+    evaluateBatch(&job, 1, &out, timings);
+  }
+
+  // evaluate() for n positions at once: each packed weight block is read
+  // once per batch instead of once per position. Results are identical.
+  void evaluateBatch(const StrategyJob* jobs, std::size_t n, StrategyOutput* outs,
+                     StrategyTimings* timings = nullptr) const {
+    for (std::size_t b = 0; b < n; ++b) {
+      StrategyOutput& out = outs[b];
+      out.reset();
+      const StrategyQuery& query = jobs[b].query;
+      if (query.heads & kStrategyPolicy) {
+        if (query.legalMoves) {
+          for (const auto& m : *query.legalMoves) out.policyMoves.push_back(static_cast<std::uint16_t>(policyIndex(m)));
         }
+        out.policy.assign(query.legalMoves ? out.policyMoves.size() : static_cast<std::size_t>(cfg.policyOutputs), 0.0f);
+      }
+    }
+    if (!enabled || stem.empty()) return;
+    simd::ScratchArena& arena = simd::scratch();
+    const simd::ScratchArena::Frame frame(arena);
+    std::size_t* live = arena.allocate<std::size_t>(n);
+    std::size_t count = 0;
+    for (std::size_t b = 0; b < n; ++b) {
+      if (!jobs[b].planes->empty()) live[count++] = b;
+    }
+    if (count == 0) return;
+
+    using Clock = std::chrono::steady_clock;
+    auto stageStart = Clock::now();
+    auto lap = [&](std::chrono::nanoseconds StrategyTimings::*stage) {
+      if (!timings) return;
+      const auto now = Clock::now();
+      timings->*stage += std::chrono::duration_cast<std::chrono::nanoseconds>(now - stageStart);
+      stageStart = now;
+    };
+
+    // Per-position rows of `channels` floats, in `live` order.
+    const std::size_t channels = static_cast<std::size_t>(cfg.channels);
+    float* state = arena.allocate<float>(count * channels);
+    std::fill_n(state, count * channels, 0.0f);
+    for (std::size_t k = 0; k < count; ++k) {
+      const auto& planes = *jobs[live[k]].planes;
+      float* s = &state[k * channels];
+      for (int p = 0; p < cfg.planes; ++p) {
+        const float x = planes[static_cast<std::size_t>(p)];
+        const float* row = &stem[static_cast<std::size_t>(p) * channels];
+        for (std::size_t c = 0; c < channels; ++c) s[c] += x * row[c];
       }
-      float qk = 0.0f;
-      for (int c = 0; c < cfg.channels; ++c) qk += q[static_cast<std::size_t>(c)] * k[static_cast<std::size_t>(c)];
-      const float attn = 1.0f / (1.0f + std::exp(-qk / std::max(1.0f, static_cast<float>(cfg.channels))));
-      for (int c = 0; c < cfg.channels; ++c) {
-        state[static_cast<std::size_t>(c)] = std::max(0.0f, state[static_cast<std::size_t>(c)] + v[static_cast<std::size_t>(c)] * attn);
+    }
+    for (std::size_t i = 0; i < count * channels; ++i) state[i] = std::max(0.0f, state[i]);
+    lap(&StrategyTimings::stem);
+
+    QuantizedVector* xs = arena.allocate<QuantizedVector>(count);
+    for (std::size_t k = 0; k < count; ++k) xs[k].q = arena.allocate<std::uint8_t>(channels);
+    std::int32_t* sums = arena.allocate<std::int32_t>(static_cast<std::size_t>(std::max(3 * cfg.channels, cfg.policyOutputs)));
+    float* qkv = arena.allocate<float>(count * 3 * channels);
+    for (const auto& layer : attentionQKV) {
+      for (std::size_t k = 0; k < count; ++k) xs[k].set(&state[k * channels], cfg.channels);
+      layer.applyBatch(xs, count, qkv, sums, pool);
+      for (std::size_t k = 0; k < count; ++k) {
+        float* s = &state[k * channels];
+        const float* q = &qkv[k * 3 * channels];
+        const float* key = q + channels;
+        const float* v = key + channels;
+        float qk = 0.0f;
+        for (std::size_t c = 0; c < channels; ++c) qk += q[c] * key[c];
+        const float attn = 1.0f / (1.0f + std::exp(-qk / std::max(1.0f, static_cast<float>(cfg.channels))));
+        for (std::size_t c = 0; c < channels; ++c) s[c] = std::max(0.0f, s[c] + v[c] * attn);
       }
     }
+    lap(&StrategyTimings::attention);
 
-    const auto routerIn = computeRouterInput(planes);
-    const auto mix = routeExperts(routerIn, phase);
-    out.expertMix = mix;
+    auto* mix = arena.allocate<std::array<float, 3>>(count);
+    for (std::size_t k = 0; k < count; ++k) {
+      const auto& job = jobs[live[k]];
+      mix[k] = routeExperts(computeRouterInput(*job.planes), job.phase);
+      outs[live[k]].expertMix = mix[k];
+    }
 
-    std::vector<float> expertState(static_cast<std::size_t>(cfg.channels), 0.0f);
+    // Each expert runs as one batch over the positions that route to it.
+    float* expertState = arena.allocate<float>(count * channels);
+    std::fill_n(expertState, count * channels, 0.0f);
+    float* local = arena.allocate<float>(count * channels);
+    float* mixValue = arena.allocate<float>(count * channels);
+    std::size_t* members = arena.allocate<std::size_t>(count);
     for (int e = 0; e < 3; ++e) {
-      const float weight = mix[static_cast<std::size_t>(e)];
-      if (weight <= 0.0f) continue;
-      std::vector<float> local = state;
-      const auto& expert = expertBlocks[static_cast<std::size_t>(e)];
+      std::size_t memberCount = 0;
+      for (std::size_t k = 0; k < count; ++k) {
+        if (mix[k][static_cast<std::size_t>(e)] > 0.0f) members[memberCount++] = k;
+      }
+      if (memberCount == 0) continue;
+      require(kExpertSection + e);
+      for (std::size_t m = 0; m < memberCount; ++m) {
+        std::copy_n(&state[members[m] * channels], channels, &local[m * channels]);
+      }
       const int depth = std::min(cfg.residualBlocks, profiles[static_cast<std::size_t>(e)].transformerLayers + cfg.residualBlocks / 2);
       for (int b = 0; b < depth; ++b) {
-        std::vector<float> next = local;
-        const std::size_t offset = static_cast<std::size_t>(b * cfg.channels * cfg.channels);
-        for (int c = 0; c < cfg.channels; ++c) {
-          float mixValue = 0.0f;
-          for (int i = 0; i < cfg.channels; ++i) {
-            mixValue += local[static_cast<std::size_t>(i)] * expert[offset + static_cast<std::size_t>(c * cfg.channels + i)];
-          }
-          next[static_cast<std::size_t>(c)] = std::max(0.0f, local[static_cast<std::size_t>(c)] + mixValue);
-        }
-        local.swap(next);
+        for (std::size_t m = 0; m < memberCount; ++m) xs[m].set(&local[m * channels], cfg.channels);
+        expertLinear[static_cast<std::size_t>(e)][static_cast<std::size_t>(b)].applyBatch(xs, memberCount, mixValue, sums, pool);
+        for (std::size_t i = 0; i < memberCount * channels; ++i) local[i] = std::max(0.0f, local[i] + mixValue[i]);
       }
-      for (int c = 0; c < cfg.channels; ++c) {
-        expertState[static_cast<std::size_t>(c)] += local[static_cast<std::size_t>(c)] * weight;
+      for (std::size_t m = 0; m < memberCount; ++m) {
+        const float weight = mix[members[m]][static_cast<std::size_t>(e)];
+        float* dst = &expertState[members[m] * channels];
+        for (std::size_t c = 0; c < channels; ++c) dst[c] += local[m * channels + c] * weight;
       }
     }
+    lap(&StrategyTimings::experts);
 
-    float value = valueBias;
-    for (int c = 0; c < cfg.channels; ++c) value += expertState[static_cast<std::size_t>(c)] * valueHead[static_cast<std::size_t>(c)];
-    out.valueCp = static_cast<int>(std::lround(value * 100.0f));
+    for (std::size_t k = 0; k < count; ++k) {
+      applyHeads(&expertState[k * channels], mix[k], jobs[live[k]].query, outs[live[k]], xs[0], sums);
+    }
+    lap(&StrategyTimings::heads);
+  }
 
-    std::vector<float> strategyBias(static_cast<std::size_t>(cfg.policyOutputs), 0.0f);
-    for (int e = 0; e < 3; ++e) {
-      const float weight = mix[static_cast<std::size_t>(e)];
-      if (weight <= 0.0f) continue;
-      for (int m = 0; m < cfg.policyOutputs; ++m) {
-        float biasLogit = 0.0f;
-        for (int c = 0; c < cfg.channels; ++c) {
-          const std::size_t wIdx = static_cast<std::size_t>(c * cfg.policyOutputs + m);
-          biasLogit += expertState[static_cast<std::size_t>(c)] * strategyBiasHead[static_cast<std::size_t>(e)][wIdx];
-        }
-        strategyBias[static_cast<std::size_t>(m)] += biasLogit * weight;
-      }
+ private:
+  void applyHeads(const float* expertState, const std::array<float, 3>& mix, const StrategyQuery& query,
+                  StrategyOutput& out, QuantizedVector& x, std::int32_t* sums) const {
+    if (query.heads & kStrategyValue) {
+      float value = valueBias;
+      for (int c = 0; c < cfg.channels; ++c) value += expertState[c] * valueHead[static_cast<std::size_t>(c)];
+      out.valueCp = static_cast<int>(std::lround(value * 100.0f));
     }
 
-    for (int m = 0; m < cfg.policyOutputs; ++m) {
-      float logit = 0.0f;
-      for (int c = 0; c < cfg.channels; ++c) {
-        const std::size_t wIdx = static_cast<std::size_t>(c * cfg.policyOutputs + m);
-        logit += expertState[static_cast<std::size_t>(c)] * policyHead[wIdx];
-      }
+    if (query.heads & kStrategyPolicy) {
+      require(kPolicySection);
       float profileBias = 0.0f;
+      for (int e = 0; e < 3; ++e) profileBias += mix[static_cast<std::size_t>(e)] * profiles[static_cast<std::size_t>(e)].policyBias;
+      x.set(expertState, cfg.channels);
+      auto head = [&](const QuantizedLinear& linear, float* logits) {
+        if (query.legalMoves) {
+          linear.applyRows(x, out.policyMoves.data(), out.policyMoves.size(), logits);
+        } else {
+          linear.apply(x, logits, sums, pool);
+        }
+      };
+      head(policyLinear, out.policy.data());
+      simd::ScratchArena& arena = simd::scratch();
+      const simd::ScratchArena::Frame frame(arena);
+      float* strategyBias = arena.allocate<float>(out.policy.size());
       for (int e = 0; e < 3; ++e) {
-        profileBias += mix[static_cast<std::size_t>(e)] * profiles[static_cast<std::size_t>(e)].policyBias;
+        const float weight = mix[static_cast<std::size_t>(e)];
+        if (weight <= 0.0f) continue;
+        head(strategyBiasLinear[static_cast<std::size_t>(e)], strategyBias);
+        for (std::size_t m = 0; m < out.policy.size(); ++m) out.policy[m] += strategyBias[m] * weight;
       }
-      out.policy[static_cast<std::size_t>(m)] = logit + strategyBias[static_cast<std::size_t>(m)] + profileBias;
+      for (float& logit : out.policy) logit += profileBias;
     }
 
-    const float winLogit = expertState[0] * wdlHead[0];
-    const float drawLogit = expertState[std::min(1, cfg.channels - 1)] * wdlHead[1];
-    const float lossLogit = expertState[std::min(2, cfg.channels - 1)] * wdlHead[2];
-    const float maxWdl = std::max({winLogit, drawLogit, lossLogit});
-    const float ew = std::exp(winLogit - maxWdl);
-    const float ed = std::exp(drawLogit - maxWdl);
-    const float el = std::exp(lossLogit - maxWdl);
-    const float norm = std::max(1e-6f, ew + ed + el);
-    out.wdl = {ew / norm, ed / norm, el / norm};
+    if (query.heads & kStrategyWdl) {
+      const float winLogit = expertState[0] * wdlHead[0];
+      const float drawLogit = expertState[std::min(1, cfg.channels - 1)] * wdlHead[1];
+      const float lossLogit = expertState[std::min(2, cfg.channels - 1)] * wdlHead[2];
+      const float maxWdl = std::max({winLogit, drawLogit, lossLogit});
+      const float ew = std::exp(winLogit - maxWdl);
+      const float ed = std::exp(drawLogit - maxWdl);
+      const float el = std::exp(lossLogit - maxWdl);
+      const float norm = std::max(1e-6f, ew + ed + el);
+      out.wdl = {ew / norm, ed / norm, el / norm};
+    }
 
     const int whiteMaterialAnchor = 4;
     const int blackMaterialAnchor = std::max(8, cfg.channels / 3);
     const int mobilityAnchor = std::max(16, cfg.channels / 2);
-    out.tacticalThreat[0] = expertState[static_cast<std::size_t>(whiteMaterialAnchor)] * tacticalHead[0];
-    out.tacticalThreat[1] = expertState[static_cast<std::size_t>(blackMaterialAnchor)] * tacticalHead[1];
-    out.kingSafety[0] = expertState[static_cast<std::size_t>(whiteMaterialAnchor + 1)] * kingSafetyHead[0];
-    out.kingSafety[1] = expertState[static_cast<std::size_t>(blackMaterialAnchor + 1)] * kingSafetyHead[1];
-    out.mobility[0] = expertState[static_cast<std::size_t>(mobilityAnchor)] * mobilityHead[0];
-    out.mobility[1] = expertState[static_cast<std::size_t>(std::min(cfg.channels - 1, mobilityAnchor + 4))] * mobilityHead[1];
+    if (query.heads & kStrategyTactical) {
+      out.tacticalThreat[0] = expertState[whiteMaterialAnchor] * tacticalHead[0];
+      out.tacticalThreat[1] = expertState[blackMaterialAnchor] * tacticalHead[1];
+    }
+    if (query.heads & kStrategyKingSafety) {
+      out.kingSafety[0] = expertState[whiteMaterialAnchor + 1] * kingSafetyHead[0];
+      out.kingSafety[1] = expertState[blackMaterialAnchor + 1] * kingSafetyHead[1];
+    }
+    if (query.heads & kStrategyMobility) {
+      out.mobility[0] = expertState[mobilityAnchor] * mobilityHead[0];
+      out.mobility[1] = expertState[std::min(cfg.channels - 1, mobilityAnchor + 4)] * mobilityHead[1];
+    }
+  }
+
+  // Checks the header and index against the configured dimensions and the
+  // core section against its checksum. Touches no other section.
+  bool readHeader() {
+    FileHeader h{};
+    if (file_->size < sizeof(h)) return false;
+    std::memcpy(&h, file_->data, sizeof(h));
+    if (h.version != kFileVersion || h.sectionCount != kSectionCount) return false;
+    if (h.planes != cfg.planes || h.channels != cfg.channels || h.transformerLayers != cfg.transformerLayers ||
+        h.residualBlocks != cfg.residualBlocks || h.policyOutputs != cfg.policyOutputs) {
+      return false;
+    }
+    for (int section = 0; section < kSectionCount; ++section) {
+      const SectionEntry& entry = h.sections[static_cast<std::size_t>(section)];
+      if (entry.offset % 64 != 0 || entry.bytes != sectionBytes(section) || entry.offset > file_->size ||
+          entry.bytes > file_->size - entry.offset) {
+        return false;
+      }
+    }
+    const SectionEntry& core = h.sections[kCoreSection];
+    if (NNUE::payloadChecksum(file_->data + core.offset, core.bytes) != core.checksum) return false;
+    header_ = h;
+    return true;
+  }
+
+  // `count` floats at float offset `at` of a legacy float file, or
+  // synthetic(i) for each when there is no such file or it stops short.
+  template <typename Synthetic>
+  void floats(std::size_t at, std::size_t count, Synthetic synthetic, float* out) const {
+    if (file_ && !sectioned_ && (at + count) * sizeof(float) <= file_->size) {
+      std::memcpy(out, file_->data + at * sizeof(float), count * sizeof(float));
+      return;
+    }
+    for (std::size_t i = 0; i < count; ++i) out[i] = synthetic(i);
+  }
+
+  void loadCore() {
+    const int c = cfg.channels;
+    const std::size_t channels = static_cast<std::size_t>(c);
+    const std::size_t square = channels * channels;
+    stem.assign(static_cast<std::size_t>(cfg.planes) * channels, 0.0f);
+    tokenProjection.assign(64 * channels, 0.0f);
+    valueHead.assign(channels, 0.0f);
+    attentionQKV.assign(static_cast<std::size_t>(cfg.transformerLayers), QuantizedLinear{});
+    if (sectioned_) {
+      const unsigned char* at = file_->data + header_.sections[kCoreSection].offset;
+      for (auto* v : {&stem, &tokenProjection, &valueHead}) {
+        std::memcpy(v->data(), at, v->size() * sizeof(float));
+        at += (v->size() * sizeof(float) + 63) / 64 * 64;
+      }
+      std::memcpy(&valueBias, at, sizeof(valueBias));
+      at += 64;
+      for (auto& layer : attentionQKV) {
+        layer.bind(file_, at, 3 * c, c);
+        at += QuantizedLinear::packedBytes(3 * c, c);
+      }
+      return;
+    }
+
+    const FloatLayout l = floatLayout();
+    floats(l.stem, stem.size(), [](std::size_t) { return 0.001f; }, stem.data());
+    floats(l.tokenProjection, tokenProjection.size(), [](std::size_t) { return 0.0008f; }, tokenProjection.data());
+    floats(l.valueHead, valueHead.size(),
+           [](std::size_t i) { return static_cast<float>((static_cast<int>(i % 13) - 6) * 0.01f); }, valueHead.data());
+    floats(l.valueBias, 1, [](std::size_t) { return 0.0f; }, &valueBias);
+    std::vector<float> qkv(3 * square);
+    for (std::size_t layer = 0; layer < attentionQKV.size(); ++layer) {
+      const std::size_t offset = layer * square;
+      floats(l.attentionQ + offset, square,
+             [&](std::size_t i) { return static_cast<float>((static_cast<int>((offset + i) % 29) - 14) * 0.0003f); },
+             qkv.data());
+      floats(l.attentionK + offset, square,
+             [&](std::size_t i) { return static_cast<float>((static_cast<int>((offset + i) % 31) - 15) * 0.0003f); },
+             qkv.data() + square);
+      floats(l.attentionV + offset, square,
+             [&](std::size_t i) { return static_cast<float>((static_cast<int>((offset + i) % 19) - 9) * 0.0004f); },
+             qkv.data() + 2 * square);
+      attentionQKV[layer].pack(qkv.data(), 3 * c, c, channels, 1);
+    }
+  }
+
+  // Binds an expert or the policy section: in place from a StrategyNet file
+  // whose checksum holds, else packed from legacy or synthetic floats.
+  void bindSection(int section) const {
+    const int c = cfg.channels;
+    const int outs = cfg.policyOutputs;
+    const std::size_t square = static_cast<std::size_t>(c) * c;
+    const std::size_t blocks = static_cast<std::size_t>(cfg.residualBlocks);
+    const std::size_t e = static_cast<std::size_t>(section - kExpertSection);
+    if (sectioned_) {
+      const SectionEntry& entry = header_.sections[static_cast<std::size_t>(section)];
+      const unsigned char* at = file_->data + entry.offset;
+      if (NNUE::payloadChecksum(at, entry.bytes) == entry.checksum) {
+        if (section == kPolicySection) {
+          policyLinear.bind(file_, at, outs, c);
+          return;
+        }
+        expertLinear[e].assign(blocks, QuantizedLinear{});
+        for (auto& block : expertLinear[e]) {
+          block.bind(file_, at, c, c);
+          at += QuantizedLinear::packedBytes(c, c);
+        }
+        strategyBiasLinear[e].bind(file_, at, outs, c);
+        return;
+      }
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The heads are stored [channel * policyOutputs + move].
+    const FloatLayout l = floatLayout();
+    const std::size_t head = static_cast<std::size_t>(c) * outs;
+    std::vector<float> src(std::max(square, head));
+    if (section == kPolicySection) {
+      floats(l.policy, head, [](std::size_t i) { return static_cast<float>((static_cast<int>(i % 17) - 8) * 0.0015f); },
+             src.data());
+      policyLinear.pack(src.data(), outs, c, 1, static_cast<std::size_t>(outs));
+      return;
+    }
+    expertLinear[e].assign(blocks, QuantizedLinear{});
+    for (std::size_t b = 0; b < blocks; ++b) {
+      floats(l.experts + (e * blocks + b) * square, square,
+             [&](std::size_t i) { return static_cast<float>((static_cast<int>((b * square + i + e) % 23) - 11) * 0.0005f); },
+             src.data());
+      expertLinear[e][b].pack(src.data(), c, c, static_cast<std::size_t>(c), 1);
+    }
+    floats(l.strategyBias + e * head, head,
+           [&](std::size_t i) { return static_cast<float>((static_cast<int>((i + 2 * e) % 37) - 18) * 0.0008f); },
+           src.data());
+    strategyBiasLinear[e].pack(src.data(), outs, c, 1, static_cast<std::size_t>(outs));
+  }
+
+  // The sectionBytes(section) bytes save() writes; dst starts zeroed.
+  void writeSection(int section, unsigned char* dst) const {
+    const int c = cfg.channels;
+    if (section == kCoreSection) {
+      for (const auto* v : {&stem, &tokenProjection, &valueHead}) {
+        std::memcpy(dst, v->data(), v->size() * sizeof(float));
+        dst += (v->size() * sizeof(float) + 63) / 64 * 64;
+      }
+      std::memcpy(dst, &valueBias, sizeof(valueBias));
+      dst += 64;
+      for (const auto& layer : attentionQKV) {
+        layer.writePacked(dst);
+        dst += QuantizedLinear::packedBytes(3 * c, c);
+      }
+      return;
+    }
+    if (section == kPolicySection) {
+      policyLinear.writePacked(dst);
+      return;
+    }
+    const std::size_t e = static_cast<std::size_t>(section - kExpertSection);
+    for (const auto& block : expertLinear[e]) {
+      block.writePacked(dst);
+      dst += QuantizedLinear::packedBytes(c, c);
+    }
+    strategyBiasLinear[e].writePacked(dst);
+  }
+
+  // Source of the sections not yet bound: a StrategyNet file (sectioned_),
+  // a legacy float file, or null for synthetic weights.
+  std::shared_ptr<const mapped_file::File> file_;
+  bool sectioned_ = false;
+  FileHeader header_{};
+  mutable std::mutex sectionMutex_;
+  mutable std::array<std::atomic<bool>, kSectionCount> resident_{};
+  mutable std::atomic<int> rejected_{0};
+};
+
+// Zobrist-keyed StrategyNet results, shared by every search thread. Each
+// entry is one cache line of relaxed atomic words whose key word is stored
+// XORed with the data, so a torn read (two writers, or a reader racing a
+// writer) fails the key check instead of returning mixed records.
+class StrategyCache {
+ public:
+  static constexpr int kTopMoves = 8;
+
+  // A StrategyOutput in 56 bytes: fixed-point heads and the kTopMoves best
+  // policy logits; every other move reads policyFloor.
+  struct Record {
+    std::int16_t valueCp;
+    std::int16_t policyFloor;           // logits are * kLogitScale
+    std::array<std::int16_t, 6> heads;  // tactical, kingSafety, mobility * kHeadScale
+    std::array<std::uint8_t, 3> wdl;
+    std::array<std::uint8_t, 3> expertMix;
+    std::uint8_t moveCount;
+    std::uint8_t reserved;
+    std::array<std::uint16_t, kTopMoves> moves;
+    std::array<std::int16_t, kTopMoves> logits;
+  };
+
+  static Record encode(const StrategyOutput& out) {
+    Record r{};
+    r.valueCp = fixed(static_cast<float>(out.valueCp), 1.0f);
+    const std::array<float, 6> heads{out.tacticalThreat[0], out.tacticalThreat[1], out.kingSafety[0],
+                                     out.kingSafety[1],     out.mobility[0],       out.mobility[1]};
+    for (std::size_t i = 0; i < heads.size(); ++i) r.heads[i] = fixed(heads[i], kHeadScale);
+    for (std::size_t i = 0; i < 3; ++i) {
+      r.wdl[i] = unit(out.wdl[i]);
+      r.expertMix[i] = unit(out.expertMix[i]);
+    }
+
+    simd::ScratchArena& arena = simd::scratch();
+    const simd::ScratchArena::Frame frame(arena);
+    const std::size_t moves = out.policy.size();
+    std::size_t* order = arena.allocate<std::size_t>(moves);
+    std::iota(order, order + moves, std::size_t{0});
+    const std::size_t kept = std::min<std::size_t>(kTopMoves, moves);
+    auto better = [&](std::size_t a, std::size_t b) { return out.policy[a] > out.policy[b]; };
+    std::partial_sort(order, order + kept, order + moves, better);
+    for (std::size_t k = 0; k < kept; ++k) {
+      const std::size_t i = order[k];
+      r.moves[k] = out.policyMoves.empty() ? static_cast<std::uint16_t>(i) : out.policyMoves[i];
+      r.logits[k] = fixed(out.policy[i], kLogitScale);
+    }
+    r.moveCount = static_cast<std::uint8_t>(kept);
+    // Best logit left out, else the worst one kept.
+    if (kept < moves) {
+      const std::size_t* rest = std::min_element(order + kept, order + moves, better);
+      r.policyFloor = fixed(out.policy[*rest], kLogitScale);
+    } else if (kept > 0) {
+      r.policyFloor = r.logits[kept - 1];
+    }
+    return r;
+  }
 
+  static StrategyOutput decode(const Record& r) {
+    StrategyOutput out;
+    out.valueCp = r.valueCp;
+    out.tacticalThreat = {r.heads[0] / kHeadScale, r.heads[1] / kHeadScale};
+    out.kingSafety = {r.heads[2] / kHeadScale, r.heads[3] / kHeadScale};
+    out.mobility = {r.heads[4] / kHeadScale, r.heads[5] / kHeadScale};
+    for (std::size_t i = 0; i < 3; ++i) {
+      out.wdl[i] = r.wdl[i] / 255.0f;
+      out.expertMix[i] = r.expertMix[i] / 255.0f;
+    }
+    for (int k = 0; k < r.moveCount; ++k) {
+      out.policyMoves.push_back(r.moves[static_cast<std::size_t>(k)]);
+      out.policy.push_back(r.logits[static_cast<std::size_t>(k)] / kLogitScale);
+    }
+    out.policyFloor = r.policyFloor / kLogitScale;
     return out;
   }
+
+  // 0 MB disables the cache.
+  void initialize(std::size_t mb) { entries_ = std::vector<Entry>(mb * 1024ULL * 1024ULL / sizeof(Entry)); }
+
+  void clear() {
+    for (auto& e : entries_) {
+      for (auto& word : e.words) word.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::size_t size() const { return entries_.size(); }
+
+  bool probe(std::uint64_t key, Record& out) const {
+    if (entries_.empty()) return false;
+    const Entry& e = entries_[static_cast<std::size_t>(key % entries_.size())];
+    std::array<std::uint64_t, kDataWords> data;
+    const std::uint64_t stored = e.words[0].load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kDataWords; ++i) data[i] = e.words[i + 1].load(std::memory_order_relaxed);
+    if ((stored ^ checksum(data)) != key || stored == 0) return false;
+    std::memcpy(&out, data.data(), sizeof(Record));
+    return true;
+  }
+
+  void store(std::uint64_t key, const Record& record) {
+    if (entries_.empty()) return;
+    Entry& e = entries_[static_cast<std::size_t>(key % entries_.size())];
+    std::array<std::uint64_t, kDataWords> data{};
+    std::memcpy(data.data(), &record, sizeof(Record));
+    for (std::size_t i = 0; i < kDataWords; ++i) e.words[i + 1].store(data[i], std::memory_order_relaxed);
+    e.words[0].store(key ^ checksum(data), std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr float kLogitScale = 256.0f;
+  static constexpr float kHeadScale = 1024.0f;
+  static constexpr std::size_t kDataWords = 7;
+  static_assert(sizeof(Record) == kDataWords * sizeof(std::uint64_t), "Record must fill the entry's data words");
+
+  struct alignas(64) Entry {
+    std::array<std::atomic<std::uint64_t>, kDataWords + 1> words{};
+  };
+
+  static std::int16_t fixed(float v, float scale) {
+    return static_cast<std::int16_t>(std::clamp<long>(std::lround(v * scale), -32767, 32767));
+  }
+  static std::uint8_t unit(float v) { return static_cast<std::uint8_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f)); }
+
+  static std::uint64_t checksum(const std::array<std::uint64_t, kDataWords>& data) {
+    std::uint64_t h = 0;
+    for (const std::uint64_t word : data) h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+    return h;
+  }
+
+  std::vector<Entry> entries_;
+};
+
+// Bounded multi-producer multi-consumer ring (Vyukov): each cell carries a
+// sequence number that says whose turn it is, so push and pop are one CAS on
+// a shared position and never block.
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(std::size_t capacity) {
+    std::size_t size = 1;
+    while (size < capacity) size <<= 1;
+    cells_ = std::vector<Cell>(size);
+    mask_ = size - 1;
+    for (std::size_t i = 0; i < size; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // False when full.
+  bool push(T&& value) {
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0 && tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      if (diff < 0) return false;
+      if (diff != 0) pos = tail_.load(std::memory_order_relaxed);
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // False when empty.
+  bool pop(T& value) {
+    std::size_t pos = head_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0 && head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      if (diff < 0) return false;
+      if (diff != 0) pos = head_.load(std::memory_order_relaxed);
+    }
+    value = std::move(cell->value);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence{0};
+    T value{};
+  };
+
+  std::vector<Cell> cells_;
+  std::size_t mask_ = 0;
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  alignas(64) std::atomic<std::size_t> head_{0};
+};
+
+// A position a search thread wants the strategy network to look at.
+struct StrategyRequest {
+  std::uint64_t key = 0;
+  std::vector<float> planes;
+  GamePhase phase = GamePhase::Middlegame;
+  std::vector<movegen::Move> legalMoves;
+};
+
+// Runs StrategyNet off the search threads. Searches post() positions and
+// carry on; one worker drains the queue in batches of up to maxBatch (or
+// whatever arrived within maxWait of the first request), evaluates them with
+// evaluateBatch() and publishes the results to the StrategyCache, where the
+// searches find them. Stop the service before changing the network.
+class StrategyService {
+ public:
+  StrategyService(const StrategyNet& net, StrategyCache& cache) : net_(net), cache_(cache) {}
+  ~StrategyService() { stop(); }
+  StrategyService(const StrategyService&) = delete;
+  StrategyService& operator=(const StrategyService&) = delete;
+
+  int maxBatch = 8;
+  std::chrono::microseconds maxWait{200};
+
+  void start() {
+    if (running_.exchange(true)) return;
+    worker_ = std::thread([this] { run(); });
+  }
+
+  // Queued requests are dropped; their searches fall back to evaluating.
+  void stop() {
+    if (!running_.exchange(false)) return;
+    wake_.notify_one();
+    worker_.join();
+    StrategyRequest dropped;
+    while (queue_.pop(dropped)) {
+    }
+  }
+
+  bool running() const { return running_.load(std::memory_order_relaxed); }
+
+  // False if the service is stopped or its queue is full.
+  bool post(StrategyRequest&& request) {
+    if (!running() || !queue_.push(std::move(request))) return false;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(sleepMutex_);
+      wake_.notify_one();
+    }
+    return true;
+  }
+
+  std::uint64_t evaluated() const { return evaluated_.load(std::memory_order_relaxed); }
+  std::uint64_t batches() const { return batches_.load(std::memory_order_relaxed); }
+
+ private:
+  void run() {
+    std::vector<StrategyRequest> batch;
+    std::vector<StrategyJob> jobs;
+    std::vector<StrategyOutput> outs;
+    StrategyRequest request;
+    StrategyCache::Record record;
+    while (running()) {
+      if (!popUntil(request, std::chrono::steady_clock::now() + std::chrono::milliseconds(1))) continue;
+      batch.clear();
+      const auto deadline = std::chrono::steady_clock::now() + maxWait;
+      for (;;) {
+        // Two searches may ask for the same position.
+        if (!cache_.probe(request.key, record)) batch.push_back(std::move(request));
+        if (static_cast<int>(batch.size()) >= maxBatch || !popUntil(request, deadline)) break;
+      }
+      if (batch.empty()) continue;
+
+      jobs.clear();
+      for (const auto& r : batch) jobs.push_back({&r.planes, r.phase, {kStrategyAllHeads, &r.legalMoves}});
+      outs.resize(batch.size());
+      net_.evaluateBatch(jobs.data(), jobs.size(), outs.data());
+      for (std::size_t i = 0; i < batch.size(); ++i) cache_.store(batch[i].key, StrategyCache::encode(outs[i]));
+      evaluated_.fetch_add(batch.size(), std::memory_order_relaxed);
+      batches_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Sleeps on wake_ rather than spinning, so a partial batch costs the
+  // search threads no CPU while it waits for company. post() only notifies
+  // a sleeping worker; the flag is raised under the lock before the queue
+  // is checked again, and `until` bounds any wakeup that still slips by.
+  bool popUntil(StrategyRequest& request, std::chrono::steady_clock::time_point until) {
+    while (running()) {
+      if (queue_.pop(request)) return true;
+      std::unique_lock<std::mutex> lock(sleepMutex_);
+      sleeping_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const bool popped = queue_.pop(request);
+      const bool timedOut = !popped && wake_.wait_until(lock, until) == std::cv_status::timeout;
+      sleeping_.store(false, std::memory_order_relaxed);
+      if (popped) return true;
+      if (timedOut) return queue_.pop(request);
+    }
+    return false;
+  }
+
+  const StrategyNet& net_;
+  StrategyCache& cache_;
+  BoundedQueue<StrategyRequest> queue_{256};
+  std::atomic<bool> running_{false};
+  std::atomic<bool> sleeping_{false};
+  std::thread worker_;
+  std::mutex sleepMutex_;
+  std::condition_variable wake_;
+  std::atomic<std::uint64_t> evaluated_{0};
+  std::atomic<std::uint64_t> batches_{0};
 };
 
 struct PolicyNet {
@@ -864,6 +2327,95 @@ struct Features {
   float policyPruneThreshold = 0.90f;
   int masterEvalTopMoves = 3;
   int multiPV = 1;
+  // Evaluation cascade (useLazyEval), in NNUE centipawns: material + PST
+  // stands in for the network when it is outside the window by more than
+  // cascadeMaterialMargin, or by anything once |material| reaches
+  // cascadeLopsided; the draft head when it is outside by more than
+  // cascadeDraftMargin. cascadecalibrate refits them from CascadeLog; the
+  // defaults cover 99% of 46,500 random-playout positions on the synthetic
+  // networks, whose output ignores material (so no lopsided shortcut).
+  int cascadeMaterialMargin = 2432;
+  int cascadeDraftMargin = 8;
+  int cascadeLopsided = 0;
+};
+
+// Tiers of the search's evaluation cascade, cheapest first.
+enum EvalTier : int { kTierMaterial = 0, kTierDraft, kTierFull, kTierCount };
+
+// How the cheaper tiers compare with the full network on sampled search
+// positions: histograms of |full - material| and |full - draft|, and of
+// |material| split by whether the network agrees with material's sign.
+// Shared by every search thread; counts are relaxed atomics.
+class CascadeLog {
+ public:
+  static constexpr int kBucketCp = 8;
+  static constexpr int kBuckets = 512;
+
+  // Scores are side-to-move centipawns of one position.
+  void record(int material, int draft, int full) {
+    add(kMaterialError, full - material);
+    add(kDraftError, full - draft);
+    add((full > 0) == (material > 0) ? kAgreeing : kDisagreeing, material);
+    samples_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::uint64_t samples() const { return samples_.load(std::memory_order_relaxed); }
+
+  void clear() {
+    for (auto& histogram : buckets_) {
+      for (auto& bucket : histogram) bucket.store(0, std::memory_order_relaxed);
+    }
+    samples_.store(0, std::memory_order_relaxed);
+  }
+
+  // Smallest margin at or above the error of `coverage` of the samples of
+  // `tier` (material or draft); -1 without samples. Errors past the last
+  // bucket count as the last bucket's bound.
+  int margin(int tier, double coverage) const {
+    const std::uint64_t total = samples();
+    if (total == 0) return -1;
+    const double target = std::clamp(coverage, 0.0, 1.0) * static_cast<double>(total);
+    std::uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+      seen += count(tier == kTierMaterial ? kMaterialError : kDraftError, b);
+      if (static_cast<double>(seen) >= target) return (b + 1) * kBucketCp;
+    }
+    return kBuckets * kBucketCp;
+  }
+
+  // Smallest |material| from which the network takes material's side in at
+  // least `coverage` of the samples, over at least 1% of all samples; 0
+  // (no lopsided shortcut) if there is none.
+  int lopsided(double coverage) const {
+    const std::uint64_t total = samples();
+    std::uint64_t agreeing = 0;
+    std::uint64_t seen = 0;
+    int best = 0;
+    for (int b = kBuckets - 1; b > 0; --b) {
+      agreeing += count(kAgreeing, b);
+      seen += count(kAgreeing, b) + count(kDisagreeing, b);
+      if (seen * 100 >= total && static_cast<double>(agreeing) >= coverage * static_cast<double>(seen)) {
+        best = b * kBucketCp;
+      }
+    }
+    return best;
+  }
+
+ private:
+  enum Histogram : int { kMaterialError = 0, kDraftError, kAgreeing, kDisagreeing, kHistograms };
+
+  void add(int histogram, int value) {
+    const int bucket = std::min(kBuckets - 1, std::abs(value) / kBucketCp);
+    buckets_[static_cast<std::size_t>(histogram)][static_cast<std::size_t>(bucket)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+  std::uint64_t count(int histogram, int bucket) const {
+    return buckets_[static_cast<std::size_t>(histogram)][static_cast<std::size_t>(bucket)].load(
+        std::memory_order_relaxed);
+  }
+
+  std::array<std::array<std::atomic<std::uint64_t>, kBuckets>, kHistograms> buckets_{};
+  std::atomic<std::uint64_t> samples_{0};
 };
 
 struct ParallelConfig {
@@ -1,8 +1,10 @@
 #include "eval.h"
 
+#include <algorithm>
 #include <array>
 #include <cctype>
 #include <cmath>
+#include <fstream>
 #include <sstream>
 
 namespace eval {
@@ -30,8 +32,28 @@ static int pst(char piece, int sq) {
   return 0;
 }
 
-int evaluate(const board::Board& b, const Params& params) {
-  int score = 0;
+namespace {
+
+// Trace policy for the search and runtime instantiations: every bookkeeping
+// branch is `if constexpr` on kEnabled and compiles away.
+struct NoTrace {
+  static constexpr bool kEnabled = false;
+};
+
+struct RuntimeParams {
+  const Params& params;
+  const Params& get() const { return params; }
+};
+
+template <const Params& P>
+struct FixedParams {
+  static constexpr const Params& get() { return P; }
+};
+
+// Piece counts gathered by the single board scan; everything past the base
+// score is derived from these without touching the board again.
+struct Scan {
+  int base = 0;  // material + PST, white relative
   int whiteBishops = 0;
   int blackBishops = 0;
   int whiteRooks = 0;
@@ -44,7 +66,18 @@ int evaluate(const board::Board& b, const Params& params) {
   int blackKingSq = -1;
   std::array<int, 8> whitePawnsByFile{};
   std::array<int, 8> blackPawnsByFile{};
+};
+
+struct PawnFlaws {
+  int doubled = 0;
+  int isolated = 0;
+  int backward = 0;
+};
 
+template <class Source, class Tr>
+Scan scanBoard(const board::Board& b, const Source& src, Tr& tr) {
+  const Params& params = src.get();
+  Scan s;
   for (int sq = 0; sq < 64; ++sq) {
     const char c = b.squares[sq];
     if (c == '.') continue;
@@ -52,107 +85,425 @@ int evaluate(const board::Board& b, const Params& params) {
     const bool white = std::isupper(static_cast<unsigned char>(c));
     const char p = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
     const int idx = p == 'p' ? 0 : p == 'n' ? 1 : p == 'b' ? 2 : p == 'r' ? 3 : p == 'q' ? 4 : 5;
-    const int material = params.piece[idx];
+    const int material = params.piece[static_cast<std::size_t>(idx)];
     const int psq = pst(c, white ? sq : (56 ^ sq));
-    const int term = material + psq;
-
-    if (white) {
-      score += term;
-    } else {
-      score -= term;
+    const int sign = white ? 1 : -1;
+    s.base += sign * (material + psq);
+    if constexpr (Tr::kEnabled) {
+      tr.material += sign * material;
+      tr.psqt += sign * psq;
+      tr.coeff[static_cast<std::size_t>(idx)] += sign;
     }
 
-    if (c == 'B') ++whiteBishops;
-    if (c == 'b') ++blackBishops;
-    if (c == 'R') ++whiteRooks;
-    if (c == 'r') ++blackRooks;
-    if (c == 'N' || c == 'B') ++whiteMinor;
-    if (c == 'n' || c == 'b') ++blackMinor;
-    if (c == 'R' || c == 'Q') ++whiteMajor;
-    if (c == 'r' || c == 'q') ++blackMajor;
-    if (c == 'K') whiteKingSq = sq;
-    if (c == 'k') blackKingSq = sq;
-    if (c == 'P') ++whitePawnsByFile[static_cast<std::size_t>(sq % 8)];
-    if (c == 'p') ++blackPawnsByFile[static_cast<std::size_t>(sq % 8)];
-  }
-
-  if (whiteBishops >= 2) score += params.bishopPairBonus;
-  if (blackBishops >= 2) score -= params.bishopPairBonus;
-  if (whiteRooks >= 2) score += params.rookPairBonus;
-  if (blackRooks >= 2) score -= params.rookPairBonus;
-
-  score += (whiteMinor - whiteMajor) * params.minorVsMajorImbalance;
-  score -= (blackMinor - blackMajor) * params.minorVsMajorImbalance;
-
-  auto pawnStructurePenalty = [&](bool whiteSide) {
-    int penalty = 0;
-    const auto& pawnsByFile = whiteSide ? whitePawnsByFile : blackPawnsByFile;
-    for (int file = 0; file < 8; ++file) {
-      int count = pawnsByFile[static_cast<std::size_t>(file)];
-      if (count <= 0) continue;
-
-      if (count > 1) {
-        penalty += (count - 1) * params.doubledPawnPenalty;
-      }
+    if (c == 'B') ++s.whiteBishops;
+    if (c == 'b') ++s.blackBishops;
+    if (c == 'R') ++s.whiteRooks;
+    if (c == 'r') ++s.blackRooks;
+    if (c == 'N' || c == 'B') ++s.whiteMinor;
+    if (c == 'n' || c == 'b') ++s.blackMinor;
+    if (c == 'R' || c == 'Q') ++s.whiteMajor;
+    if (c == 'r' || c == 'q') ++s.blackMajor;
+    if (c == 'K') s.whiteKingSq = sq;
+    if (c == 'k') s.blackKingSq = sq;
+    if (c == 'P') ++s.whitePawnsByFile[static_cast<std::size_t>(sq % 8)];
+    if (c == 'p') ++s.blackPawnsByFile[static_cast<std::size_t>(sq % 8)];
+  }
+  return s;
+}
 
-      const bool hasLeft = file > 0 && pawnsByFile[static_cast<std::size_t>(file - 1)] > 0;
-      const bool hasRight = file < 7 && pawnsByFile[static_cast<std::size_t>(file + 1)] > 0;
-      if (!hasLeft && !hasRight) {
-        penalty += count * params.isolatedPawnPenalty;
-      }
+// Material + PST + pair/imbalance terms + tempo, side-to-move relative.
+template <class Source, class Tr>
+int baseScore(bool whiteToMove, const Source& src, const Scan& s, Tr& tr) {
+  const Params& params = src.get();
+  const int bishopPairs = (s.whiteBishops >= 2 ? 1 : 0) - (s.blackBishops >= 2 ? 1 : 0);
+  const int rookPairs = (s.whiteRooks >= 2 ? 1 : 0) - (s.blackRooks >= 2 ? 1 : 0);
+  const int imbalance = (s.whiteMinor - s.whiteMajor) - (s.blackMinor - s.blackMajor);
+  const int tempo = whiteToMove ? 1 : -1;
 
-      if ((file == 2 || file == 3 || file == 4 || file == 5) && !hasLeft && !hasRight) {
-        penalty += count * params.backwardPawnPenalty;
+  const int score = s.base + bishopPairs * params.bishopPairBonus + rookPairs * params.rookPairBonus +
+                    imbalance * params.minorVsMajorImbalance + tempo * params.tempoBonus;
+  if constexpr (Tr::kEnabled) {
+    tr.bishopPair = bishopPairs * params.bishopPairBonus;
+    tr.rookPair = rookPairs * params.rookPairBonus;
+    tr.imbalance = imbalance * params.minorVsMajorImbalance;
+    tr.tempo = tempo * params.tempoBonus;
+    tr.coeff[kBishopPair] = bishopPairs;
+    tr.coeff[kRookPair] = rookPairs;
+    tr.coeff[kMinorVsMajor] = imbalance;
+    tr.coeff[kTempo] = tempo;
+  }
+  return whiteToMove ? score : -score;
+}
+
+PawnFlaws pawnFlaws(const std::array<int, 8>& pawnsByFile) {
+  PawnFlaws flaws;
+  for (int file = 0; file < 8; ++file) {
+    const int count = pawnsByFile[static_cast<std::size_t>(file)];
+    if (count <= 0) continue;
+
+    if (count > 1) flaws.doubled += count - 1;
+
+    const bool hasLeft = file > 0 && pawnsByFile[static_cast<std::size_t>(file - 1)] > 0;
+    const bool hasRight = file < 7 && pawnsByFile[static_cast<std::size_t>(file + 1)] > 0;
+    if (!hasLeft && !hasRight) {
+      flaws.isolated += count;
+      if (file >= 2 && file <= 5) flaws.backward += count;
+    }
+  }
+  return flaws;
+}
+
+// Squares in front of a king that hold its shield pawns, per side (White,
+// Black) and king square.
+const std::array<std::array<std::uint64_t, 64>, 2>& shieldMasks() {
+  static const std::array<std::array<std::uint64_t, 64>, 2> masks = [] {
+    std::array<std::array<std::uint64_t, 64>, 2> m{};
+    for (int side = 0; side < 2; ++side) {
+      for (int sq = 0; sq < 64; ++sq) {
+        const int rank = sq / 8 + (side == 0 ? 1 : -1);
+        if (rank < 0 || rank > 7) continue;
+        for (int df = -1; df <= 1; ++df) {
+          const int file = sq % 8 + df;
+          if (file >= 0 && file <= 7) m[static_cast<std::size_t>(side)][static_cast<std::size_t>(sq)] |= 1ULL << (rank * 8 + file);
+        }
       }
     }
-    return penalty;
-  };
+    return m;
+  }();
+  return masks;
+}
 
-  score -= pawnStructurePenalty(true);
-  score += pawnStructurePenalty(false);
+// Shield pawn counts, the one positional input Scan does not carry.
+struct Shields {
+  int white = 0;
+  int black = 0;
+};
 
-  auto kingSafetyMask = [&](int kingSq, bool whiteSide) {
+Shields shieldPawns(const board::Board& b, const Scan& s) {
+  auto count = [&](int kingSq, int side, char pawn) {
     if (kingSq < 0) return 0;
-    const int rank = kingSq / 8;
-    const int backRank = whiteSide ? 0 : 7;
-    const int centerDistance = std::abs((kingSq % 8) - 3) + std::abs(rank - 3);
-    const int shieldRank = whiteSide ? rank + 1 : rank - 1;
     int shield = 0;
-    for (int df = -1; df <= 1; ++df) {
-      const int file = (kingSq % 8) + df;
-      if (file < 0 || file > 7 || shieldRank < 0 || shieldRank > 7) continue;
-      const int sq = shieldRank * 8 + file;
-      const char pawn = whiteSide ? 'P' : 'p';
-      if (b.squares[static_cast<std::size_t>(sq)] == pawn) ++shield;
+    for (std::uint64_t bb = shieldMasks()[static_cast<std::size_t>(side)][static_cast<std::size_t>(kingSq)]; bb; bb &= bb - 1) {
+      if (b.squares[static_cast<std::size_t>(__builtin_ctzll(bb))] == pawn) ++shield;
     }
-    const int openingMask = (shield * 4) - std::abs(rank - backRank) * 2;
-    const int endgameMask = (6 - centerDistance);
-    const bool endgame = (whiteMajor + blackMajor) <= 2;
-    return endgame ? endgameMask : openingMask;
+    return shield;
   };
+  return {count(s.whiteKingSq, 0, 'P'), count(s.blackKingSq, 1, 'p')};
+}
+
+int kingSafetyMask(int kingSq, int shield, bool whiteSide, bool endgame) {
+  if (kingSq < 0) return 0;
+  const int rank = kingSq / 8;
+  const int backRank = whiteSide ? 0 : 7;
+  const int centerDistance = std::abs((kingSq % 8) - 3) + std::abs(rank - 3);
+  const int openingMask = (shield * 4) - std::abs(rank - backRank) * 2;
+  const int endgameMask = (6 - centerDistance);
+  return endgame ? endgameMask : openingMask;
+}
+
+int kingActivity(int sq) { return sq < 0 ? 0 : 6 - (std::abs((sq % 8) - 3) + std::abs((sq / 8) - 3)); }
+
+// Pawn structure, king safety and mobility/king activity, side-to-move relative.
+template <class Source, class Tr>
+int positionalScore(bool whiteToMove, const Source& src, const Scan& s, const Shields& shields, Tr& tr) {
+  const Params& params = src.get();
+  const PawnFlaws white = pawnFlaws(s.whitePawnsByFile);
+  const PawnFlaws black = pawnFlaws(s.blackPawnsByFile);
+  const int doubled = black.doubled - white.doubled;
+  const int isolated = black.isolated - white.isolated;
+  const int backward = black.backward - white.backward;
+  const int pawn = doubled * params.doubledPawnPenalty + isolated * params.isolatedPawnPenalty +
+                   backward * params.backwardPawnPenalty;
+
+  const bool endgame = (s.whiteMajor + s.blackMajor) <= 2;
+  const int mask = kingSafetyMask(s.whiteKingSq, shields.white, true, endgame) -
+                   kingSafetyMask(s.blackKingSq, shields.black, false, endgame);
+  const int king = mask * params.kingSafetyPhaseMaskBonus;
+
+  const int activity = endgame ? kingActivity(s.whiteKingSq) - kingActivity(s.blackKingSq) : 0;
+  const int pieces = endgame ? 0 : (s.whiteMinor + s.whiteMajor) - (s.blackMinor + s.blackMajor);
+  const int mobility = activity * params.endgameKingActivityBonus + pieces * params.openingMobilityBonus;
+
+  if constexpr (Tr::kEnabled) {
+    tr.pawnStructure = pawn;
+    tr.kingSafety = king;
+    tr.kingActivity = activity * params.endgameKingActivityBonus;
+    tr.mobility = pieces * params.openingMobilityBonus;
+    tr.coeff[kDoubledPawn] = doubled;
+    tr.coeff[kIsolatedPawn] = isolated;
+    tr.coeff[kBackwardPawn] = backward;
+    tr.coeff[kKingSafetyMask] = mask;
+    tr.coeff[kEndgameKingActivity] = activity;
+    tr.coeff[kOpeningMobility] = pieces;
+  }
+
+  const int score = pawn + king + mobility;
+  return whiteToMove ? score : -score;
+}
+
+template <bool Lazy, class Source, class Tr>
+int evaluateImpl(const board::Board& b, const Source& src, int alpha, int beta, LazyStats* stats, Tr& tr) {
+  const Scan s = scanBoard(b, src, tr);
+  const int base = baseScore(b.whiteToMove, src, s, tr);
+  if constexpr (Lazy) {
+    const int margin = src.get().lazyMargin;
+    if (stats) ++stats->calls;
+    if (base - margin >= beta || base + margin <= alpha) {
+      if (stats) ++stats->earlyExits;
+      return base;
+    }
+  }
+  const int positional = positionalScore(b.whiteToMove, src, s, shieldPawns(b, s), tr);
+  if constexpr (Lazy) {
+    if (stats) stats->maxPositional = std::max(stats->maxPositional, std::abs(positional));
+  }
+  return base + positional;
+}
+
+}  // namespace
+
+const char* paramName(int idx) {
+  static const std::array<const char*, kParamCount> names = {
+      "pawnValue",           "knightValue",         "bishopValue",
+      "rookValue",           "queenValue",          "kingValue",
+      "bishopPairBonus",     "rookPairBonus",       "minorVsMajorImbalance",
+      "tempoBonus",          "isolatedPawnPenalty", "doubledPawnPenalty",
+      "backwardPawnPenalty", "kingSafetyPhaseMaskBonus", "endgameKingActivityBonus",
+      "openingMobilityBonus"};
+  return idx >= 0 && idx < kParamCount ? names[static_cast<std::size_t>(idx)] : "";
+}
+
+void setParam(Params& p, int idx, int value) {
+  switch (idx) {
+    case kBishopPair: p.bishopPairBonus = value; break;
+    case kRookPair: p.rookPairBonus = value; break;
+    case kMinorVsMajor: p.minorVsMajorImbalance = value; break;
+    case kTempo: p.tempoBonus = value; break;
+    case kIsolatedPawn: p.isolatedPawnPenalty = value; break;
+    case kDoubledPawn: p.doubledPawnPenalty = value; break;
+    case kBackwardPawn: p.backwardPawnPenalty = value; break;
+    case kKingSafetyMask: p.kingSafetyPhaseMaskBonus = value; break;
+    case kEndgameKingActivity: p.endgameKingActivityBonus = value; break;
+    case kOpeningMobility: p.openingMobilityBonus = value; break;
+    default:
+      if (idx >= 0 && idx < 6) p.piece[static_cast<std::size_t>(idx)] = value;
+      break;
+  }
+}
+
+bool saveParams(const std::string& path, const Params& params) {
+  std::ofstream out(path);
+  if (!out) return false;
+  for (int i = 0; i < kParamCount; ++i) out << paramName(i) << ' ' << param(params, i) << '\n';
+  out << "lazyMargin " << params.lazyMargin << '\n';
+  return static_cast<bool>(out);
+}
+
+bool loadParams(const std::string& path, Params& params) {
+  std::ifstream in(path);
+  if (!in) return false;
+  Params loaded = params;
+  std::string name;
+  int value = 0;
+  while (in >> name >> value) {
+    if (name == "lazyMargin") {
+      loaded.lazyMargin = value;
+      continue;
+    }
+    int idx = 0;
+    while (idx < kParamCount && name != paramName(idx)) ++idx;
+    if (idx == kParamCount) return false;
+    setParam(loaded, idx, value);
+  }
+  if (!in.eof()) return false;
+  params = loaded;
+  return true;
+}
 
-  score += kingSafetyMask(whiteKingSq, true) * params.kingSafetyPhaseMaskBonus;
-  score -= kingSafetyMask(blackKingSq, false) * params.kingSafetyPhaseMaskBonus;
+bool sameWeights(const Params& a, const Params& b) {
+  for (int i = 0; i < kParamCount; ++i) {
+    if (param(a, i) != param(b, i)) return false;
+  }
+  return a.lazyMargin == b.lazyMargin;
+}
+
+int evaluate(const board::Board& b, const Params& params) {
+  NoTrace tr;
+  return evaluateImpl<false>(b, RuntimeParams{params}, 0, 0, nullptr, tr);
+}
+
+int evaluate(const board::Board& b, const Params& params, int alpha, int beta, LazyStats* stats) {
+  NoTrace tr;
+  return evaluateImpl<true>(b, RuntimeParams{params}, alpha, beta, stats, tr);
+}
+
+int evaluateTuned(const board::Board& b) {
+  NoTrace tr;
+  return evaluateImpl<false>(b, FixedParams<kTunedParams>{}, 0, 0, nullptr, tr);
+}
+
+int evaluateTuned(const board::Board& b, int alpha, int beta, LazyStats* stats) {
+  NoTrace tr;
+  return evaluateImpl<true>(b, FixedParams<kTunedParams>{}, alpha, beta, stats, tr);
+}
 
-  const bool endgame = (whiteMajor + blackMajor) <= 2;
-  if (endgame) {
-    auto kingActivity = [](int sq) { return 6 - (std::abs((sq % 8) - 3) + std::abs((sq / 8) - 3)); };
-    if (whiteKingSq >= 0) score += kingActivity(whiteKingSq) * params.endgameKingActivityBonus;
-    if (blackKingSq >= 0) score -= kingActivity(blackKingSq) * params.endgameKingActivityBonus;
-  } else {
-    score += (whiteMinor + whiteMajor) * params.openingMobilityBonus;
-    score -= (blackMinor + blackMajor) * params.openingMobilityBonus;
+int trace(const board::Board& b, const Params& params, Trace& out) {
+  out = Trace{};
+  return evaluateImpl<false>(b, RuntimeParams{params}, 0, 0, nullptr, out);
+}
+
+namespace {
+
+constexpr std::uint64_t kFileA = 0x0101010101010101ULL;
+
+int pieceSlot(char c) {
+  switch (c) {
+    case 'P': return 0; case 'N': return 1; case 'B': return 2; case 'R': return 3; case 'Q': return 4; case 'K': return 5;
+    case 'p': return 6; case 'n': return 7; case 'b': return 8; case 'r': return 9; case 'q': return 10; case 'k': return 11;
+    default: return -1;
+  }
+}
+
+int popcount(std::uint64_t bb) { return __builtin_popcountll(bb); }
+
+// The counts scanBoard() gathers, read off one lane's bitboards; base is
+// left for the material and PST passes.
+Scan laneScan(const PositionBatch& batch, std::size_t i) {
+  const auto& pc = batch.pieces;
+  Scan s;
+  s.whiteBishops = popcount(pc[2][i]);
+  s.blackBishops = popcount(pc[8][i]);
+  s.whiteRooks = popcount(pc[3][i]);
+  s.blackRooks = popcount(pc[9][i]);
+  s.whiteMinor = popcount(pc[1][i]) + s.whiteBishops;
+  s.blackMinor = popcount(pc[7][i]) + s.blackBishops;
+  s.whiteMajor = s.whiteRooks + popcount(pc[4][i]);
+  s.blackMajor = s.blackRooks + popcount(pc[10][i]);
+  s.whiteKingSq = pc[5][i] ? __builtin_ctzll(pc[5][i]) : -1;
+  s.blackKingSq = pc[11][i] ? __builtin_ctzll(pc[11][i]) : -1;
+  for (int file = 0; file < 8; ++file) {
+    s.whitePawnsByFile[static_cast<std::size_t>(file)] = popcount(pc[0][i] & (kFileA << file));
+    s.blackPawnsByFile[static_cast<std::size_t>(file)] = popcount(pc[6][i] & (kFileA << file));
   }
+  return s;
+}
 
-  score += b.whiteToMove ? params.tempoBonus : -params.tempoBonus;
+Shields laneShields(const PositionBatch& batch, std::size_t i, const Scan& s) {
+  const auto& pc = batch.pieces;
+  Shields shields;
+  if (s.whiteKingSq >= 0) shields.white = popcount(pc[0][i] & shieldMasks()[0][static_cast<std::size_t>(s.whiteKingSq)]);
+  if (s.blackKingSq >= 0) shields.black = popcount(pc[6][i] & shieldMasks()[1][static_cast<std::size_t>(s.blackKingSq)]);
+  return shields;
+}
+
+}  // namespace
 
-  return b.whiteToMove ? score : -score;
+void PositionBatch::assign(const board::Board* positions, std::size_t n) {
+  count = n;
+  for (auto& lane : pieces) lane.assign(n, 0);
+  whiteToMove.assign(n, 0);
+  for (std::size_t i = 0; i < n; ++i) {
+    const board::Board& b = positions[i];
+    for (int sq = 0; sq < 64; ++sq) {
+      const int slot = pieceSlot(b.squares[static_cast<std::size_t>(sq)]);
+      if (slot >= 0) pieces[static_cast<std::size_t>(slot)][i] |= 1ULL << sq;
+    }
+    whiteToMove[i] = b.whiteToMove ? 1 : 0;
+  }
+}
+
+void evaluateBatch(const PositionBatch& batch, const Params& params, int* out) {
+  const std::size_t n = batch.count;
+  const auto& pc = batch.pieces;
+
+  // Material, one pass per piece type across all lanes.
+  for (std::size_t i = 0; i < n; ++i) out[i] = 0;
+  for (std::size_t t = 0; t < 6; ++t) {
+    const int value = params.piece[t];
+    const std::uint64_t* white = pc[t].data();
+    const std::uint64_t* black = pc[t + 6].data();
+    for (std::size_t i = 0; i < n; ++i) out[i] += (popcount(white[i]) - popcount(black[i])) * value;
+  }
+
+  // Knight PST; the only piece with a table.
+  for (std::size_t i = 0; i < n; ++i) {
+    int psq = 0;
+    for (std::uint64_t bb = pc[1][i]; bb; bb &= bb - 1) psq += knightPst(__builtin_ctzll(bb));
+    for (std::uint64_t bb = pc[7][i]; bb; bb &= bb - 1) psq -= knightPst(56 ^ __builtin_ctzll(bb));
+    out[i] += psq;
+  }
+
+  // Everything past material + PST goes through the scalar term code,
+  // fed from per-lane counts.
+  NoTrace tr;
+  const RuntimeParams src{params};
+  for (std::size_t i = 0; i < n; ++i) {
+    Scan s = laneScan(batch, i);
+    s.base = out[i];
+    const bool whiteToMove = batch.whiteToMove[i] != 0;
+    out[i] = baseScore(whiteToMove, src, s, tr) + positionalScore(whiteToMove, src, s, laneShields(batch, i, s), tr);
+  }
+}
+
+void evaluateBatch(const board::Board* positions, std::size_t count, const Params& params, int* out) {
+  PositionBatch batch;
+  batch.assign(positions, count);
+  evaluateBatch(batch, params, out);
+}
+
+int pieceSquareScore(char piece, int sq, const Params& params) {
+  if (piece == '.') return 0;
+  const bool white = std::isupper(static_cast<unsigned char>(piece));
+  const char p = static_cast<char>(std::tolower(static_cast<unsigned char>(piece)));
+  const int idx = p == 'p' ? 0 : p == 'n' ? 1 : p == 'b' ? 2 : p == 'r' ? 3 : p == 'q' ? 4 : 5;
+  const int score = params.piece[static_cast<std::size_t>(idx)] + pst(piece, white ? sq : (56 ^ sq));
+  return white ? score : -score;
+}
+
+int materialPst(const board::Board& b, const Params& params) {
+  int score = 0;
+  for (int sq = 0; sq < 64; ++sq) score += pieceSquareScore(b.squares[static_cast<std::size_t>(sq)], sq, params);
+  return score;
+}
+
+int materialPstDelta(const board::DirtyPieces& dirty, const Params& params) {
+  int delta = 0;
+  for (int i = 0; i < dirty.count; ++i) {
+    const board::DirtyPiece& d = dirty.pieces[static_cast<std::size_t>(i)];
+    if (d.from >= 0) delta -= pieceSquareScore(d.piece, d.from, params);
+    if (d.to >= 0) delta += pieceSquareScore(d.piece, d.to, params);
+  }
+  return delta;
+}
+
+int lazyMarginPercentile(std::vector<int>& magnitudes, int fallback, double coverage) {
+  if (magnitudes.empty()) return fallback;
+  const double clamped = std::clamp(coverage, 0.0, 1.0);
+  const std::size_t idx = std::min(magnitudes.size() - 1, static_cast<std::size_t>(clamped * static_cast<double>(magnitudes.size())));
+  std::nth_element(magnitudes.begin(), magnitudes.begin() + static_cast<std::ptrdiff_t>(idx), magnitudes.end());
+  return magnitudes[idx];
+}
+
+int calibrateLazyMargin(const std::vector<board::Board>& sample, const Params& params, double coverage) {
+  std::vector<int> magnitudes;
+  magnitudes.reserve(sample.size());
+  NoTrace tr;
+  const RuntimeParams src{params};
+  for (const auto& b : sample) {
+    const Scan s = scanBoard(b, src, tr);
+    magnitudes.push_back(std::abs(positionalScore(b.whiteToMove, src, s, shieldPawns(b, s), tr)));
+  }
+  return lazyMarginPercentile(magnitudes, params.lazyMargin, coverage);
 }
 
 std::string breakdown(const board::Board& b, const Params& params) {
+  Trace t;
+  const int score = trace(b, params, t);
   std::ostringstream out;
-  out << "eval=" << evaluate(b, params) << " stm=" << (b.whiteToMove ? 'w' : 'b')
-      << " bp=" << params.bishopPairBonus << " tempo=" << params.tempoBonus;
+  out << "eval=" << score << " stm=" << (b.whiteToMove ? 'w' : 'b') << " material=" << t.material
+      << " psqt=" << t.psqt << " bishopPair=" << t.bishopPair << " rookPair=" << t.rookPair
+      << " imbalance=" << t.imbalance << " pawn=" << t.pawnStructure << " king=" << t.kingSafety
+      << " kingActivity=" << t.kingActivity << " mobility=" << t.mobility << " tempo=" << t.tempo;
   return out.str();
 }
 
@@ -2,12 +2,17 @@
 #define EVAL_H
 
 #include <array>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "board.h"
 
 namespace eval {
 
+// Share of positions whose positional terms lazyMargin must cover (99.9%).
+inline constexpr double kLazyMarginCoverage = 0.999;
+
 struct Params {
   std::array<int, 6> piece{100, 320, 330, 500, 900, 0};
   int bishopPairBonus = 30;
@@ -20,10 +25,130 @@ struct Params {
   int kingSafetyPhaseMaskBonus = 10;
   int endgameKingActivityBonus = 10;
   int openingMobilityBonus = 8;
+  int lazyMargin = 170;  // covers ~99.9% (kLazyMarginCoverage) of |pawn + king + mobility|, see calibrateLazyMargin
+};
+
+// Tuned constants the search instantiation is compiled against.
+inline constexpr Params kTunedParams{};
+
+// Index of every evaluation weight in Params; lazyMargin is a search knob,
+// not a weight, and has no index.
+enum ParamIndex : int {
+  kPawnValue = 0,
+  kKnightValue,
+  kBishopValue,
+  kRookValue,
+  kQueenValue,
+  kKingValue,
+  kBishopPair,
+  kRookPair,
+  kMinorVsMajor,
+  kTempo,
+  kIsolatedPawn,
+  kDoubledPawn,
+  kBackwardPawn,
+  kKingSafetyMask,
+  kEndgameKingActivity,
+  kOpeningMobility,
+  kParamCount
+};
+
+constexpr int param(const Params& p, int idx) {
+  switch (idx) {
+    case kBishopPair: return p.bishopPairBonus;
+    case kRookPair: return p.rookPairBonus;
+    case kMinorVsMajor: return p.minorVsMajorImbalance;
+    case kTempo: return p.tempoBonus;
+    case kIsolatedPawn: return p.isolatedPawnPenalty;
+    case kDoubledPawn: return p.doubledPawnPenalty;
+    case kBackwardPawn: return p.backwardPawnPenalty;
+    case kKingSafetyMask: return p.kingSafetyPhaseMaskBonus;
+    case kEndgameKingActivity: return p.endgameKingActivityBonus;
+    case kOpeningMobility: return p.openingMobilityBonus;
+    default: return idx >= 0 && idx < 6 ? p.piece[static_cast<std::size_t>(idx)] : 0;
+  }
+}
+
+const char* paramName(int idx);
+void setParam(Params& p, int idx, int value);
+bool sameWeights(const Params& a, const Params& b);
+// Params files are `name value` lines, one per weight plus lazyMargin; unknown
+// names are rejected so a stale file cannot silently half-apply.
+bool saveParams(const std::string& path, const Params& params);
+bool loadParams(const std::string& path, Params& params);
+
+// Every term of one evaluation, white relative, plus the coefficient each
+// weight was multiplied by. The evaluation is linear in Params, so
+// psqt + sum(coeff[i] * param(i)) reproduces the white-relative score.
+struct Trace {
+  static constexpr bool kEnabled = true;
+
+  int material = 0;
+  int psqt = 0;
+  int bishopPair = 0;
+  int rookPair = 0;
+  int imbalance = 0;
+  int pawnStructure = 0;
+  int kingSafety = 0;
+  int kingActivity = 0;
+  int mobility = 0;
+  int tempo = 0;
+  std::array<int, kParamCount> coeff{};
+
+  int total() const {
+    return material + psqt + bishopPair + rookPair + imbalance + pawnStructure + kingSafety + kingActivity + mobility +
+           tempo;
+  }
+};
+
+// Counters for the window-aware evaluate(); owned by the caller so search
+// threads never share them.
+struct LazyStats {
+  std::uint64_t calls = 0;
+  std::uint64_t earlyExits = 0;
+  int maxPositional = 0;  // largest |positional term| seen on full evaluations
+
+  double earlyExitRate() const { return calls ? static_cast<double>(earlyExits) / static_cast<double>(calls) : 0.0; }
 };
 
 void initialize(Params& params);
+// Runtime-Params instantiation, used by tuning runs and loaded params files.
 int evaluate(const board::Board& b, const Params& params);
+// Computes material + PST + imbalance + tempo first and returns it when it is
+// outside [alpha, beta] by more than params.lazyMargin; otherwise adds the
+// pawn, king-safety and mobility terms. Scores are side-to-move relative.
+int evaluate(const board::Board& b, const Params& params, int alpha, int beta, LazyStats* stats = nullptr);
+// Search instantiation: kTunedParams folded in at compile time, no tracing.
+int evaluateTuned(const board::Board& b);
+int evaluateTuned(const board::Board& b, int alpha, int beta, LazyStats* stats = nullptr);
+// Tracing instantiation for explain and tuning; returns the side-to-move score.
+int trace(const board::Board& b, const Params& params, Trace& out);
+// Structure-of-arrays view of many positions: one bitboard array per piece
+// type with one lane per position, so material and PST are straight loops
+// across the batch and the other terms read per-lane counts through the
+// same code as evaluate(). Reuse one batch to avoid reallocating.
+struct PositionBatch {
+  std::size_t count = 0;
+  std::array<std::vector<std::uint64_t>, 12> pieces;  // P N B R Q K p n b r q k
+  std::vector<std::uint8_t> whiteToMove;
+
+  void assign(const board::Board* positions, std::size_t n);
+};
+
+// Same scores as evaluate(b, params) for every lane, written to out[0..count).
+void evaluateBatch(const PositionBatch& batch, const Params& params, int* out);
+void evaluateBatch(const board::Board* positions, std::size_t count, const Params& params, int* out);
+// Material + PST, the first part of evaluate()'s base score, white relative:
+// the whole board, one piece, and the change a move's dirty pieces make, so
+// search can keep it incrementally.
+int materialPst(const board::Board& b, const Params& params);
+int pieceSquareScore(char piece, int sq, const Params& params);
+int materialPstDelta(const board::DirtyPieces& dirty, const Params& params);
+// Smallest value at or above `coverage` of `magnitudes` (reordered in place),
+// `fallback` when there are none. Shared by calibrateLazyMargin and the tuner.
+int lazyMarginPercentile(std::vector<int>& magnitudes, int fallback, double coverage = kLazyMarginCoverage);
+// Smallest margin covering `coverage` of the positional terms over `sample`.
+int calibrateLazyMargin(const std::vector<board::Board>& sample, const Params& params, double coverage = kLazyMarginCoverage);
 std::string breakdown(const board::Board& b, const Params& params);
 
 }  // namespace eval
@@ -1,8 +1,11 @@
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
 #include <fstream>
 #include <numeric>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <sstream>
 #include <string>
@@ -13,7 +16,9 @@
 #include "eval.h"
 #include "movegen.h"
 #include "search.h"
+#include "simd.h"
 #include "tt.h"
+#include "tune.h"
 
 namespace engine {
 
@@ -21,12 +26,12 @@ struct State {
   board::Board board;
   tt::Table tt;
   eval::Params evalParams;
-  std::mt19937 rng{std::random_device{}()};
   std::ofstream logFile;
   bool running = true;
-  bool stopRequested = false;
+  std::atomic<bool> stopRequested{false};
   std::uint64_t perftNodes = 0;
   std::string openingCachePath = "opening_cache.txt";
+  std::string evalParamsPath = "eval_params.txt";
 
   engine_components::representation::AttackTables attacks;
   engine_components::representation::MagicTables magic;
@@ -36,17 +41,26 @@ struct State {
   engine_components::search_arch::Features features;
   engine_components::search_arch::ParallelConfig parallel;
   engine_components::search_arch::MCTSConfig mcts;
+  engine_components::search_arch::CascadeLog cascadeLog;
+  // Off by default: a sample costs a full network evaluation.
+  bool cascadeSample = false;
   engine_components::search_helpers::KillerTable killer;
   engine_components::search_helpers::HistoryHeuristic history;
   engine_components::search_helpers::CounterMoveTable counter;
   engine_components::search_helpers::PVTable pvTable;
   engine_components::search_helpers::SEE see;
   engine_components::search_helpers::SearchResultCache cache;
+  // Lazy SMP helpers, Threads - 1 of them.
+  std::unique_ptr<search::SearchThreads> searchThreads;
 
   engine_components::eval_model::Handcrafted handcrafted;
   engine_components::eval_model::EndgameHeuristics endgame;
   engine_components::eval_model::NNUE nnue;
+  // Declared before the network so it outlives every user of the pointer.
+  std::unique_ptr<engine_components::eval_model::TaskPool> strategyPool;
   engine_components::eval_model::StrategyNet strategyNet;
+  engine_components::eval_model::StrategyCache strategyCache;
+  engine_components::eval_model::StrategyService strategyService{strategyNet, strategyCache};
   engine_components::eval_model::PolicyNet policy;
   engine_components::eval_model::TrainingInfra training;
 
@@ -74,16 +88,24 @@ std::string describeFeatures(const State& state) {
       << " pvPrune=" << state.features.usePolicyValuePruning
       << " lazy=" << state.features.useLazyEval
       << " topK=" << state.features.policyTopK
-      << " masterTop=" << state.features.masterEvalTopMoves << "] ";
+      << " masterTop=" << state.features.masterEvalTopMoves
+      << " cascade=" << state.features.cascadeMaterialMargin << '/' << state.features.cascadeDraftMargin << '/'
+      << state.features.cascadeLopsided << "] ";
 
-  out << "nnue[enabled=" << state.nnue.enabled << " amx=" << state.nnue.cfg.useAMXPath
+  out << "nnue[enabled=" << state.nnue.enabled << " simd=" << simd::name(simd::kernels().level)
       << " inputs=" << state.nnue.cfg.inputs << " h1=" << state.nnue.cfg.hidden1
-      << " h2=" << state.nnue.cfg.hidden2 << "] ";
+      << " h2=" << state.nnue.cfg.hidden2 << " mapped=" << state.nnue.weightsMapped << "] ";
 
   out << "strategy[enabled=" << state.strategyNet.enabled
       << " policyOut=" << state.strategyNet.cfg.policyOutputs
       << " hardPhase=" << state.strategyNet.cfg.useHardPhaseSwitch
-      << " experts=" << state.strategyNet.cfg.activeExperts << "] ";
+      << " experts=" << state.strategyNet.cfg.activeExperts
+      << " threads=" << (state.strategyPool ? state.strategyPool->threads() : 1)
+      << " mapped=" << state.strategyNet.weightsMapped << " resident=";
+  for (int section = 0; section < engine_components::eval_model::StrategyNet::kSectionCount; ++section) {
+    out << (state.strategyNet.resident(section) ? '1' : '0');
+  }
+  out << " rejected=" << state.strategyNet.rejectedSections() << "] ";
 
   out << "m2cts[batch=" << state.mcts.miniBatchSize
       << " vloss=" << state.mcts.virtualLoss
@@ -129,7 +151,9 @@ std::string openingKey(const State& state) {
 void initialize(State& state) {
   state.board.setStartPos();
   state.tt.initialize(64);
+  state.strategyCache.initialize(4);
   eval::initialize(state.evalParams);
+  eval::loadParams(state.evalParamsPath, state.evalParams);
   state.attacks.initialize();
   state.magic.initialize();
   state.zobrist.initialize();
@@ -167,6 +191,7 @@ void initialize(State& state) {
   state.features.masterEvalTopMoves = 3;
   state.nnue.load("nnue.bin");
   state.strategyNet.load("strategy_large.nn");
+  state.strategyService.start();
   state.policy.priors = {0.70f, 0.20f, 0.10f};
   state.ramTablebase.enabled = false;
   state.cache.load(state.openingCachePath);
@@ -197,20 +222,45 @@ void printUciId() {
   std::cout << "option name EnableCAT type check default true\n";
   std::cout << "option name UseStrategyNN type check default true\n";
   std::cout << "option name StrategyPolicyOutputs type spin default 4096 min 64 max 4096\n";
+  std::cout << "option name StrategyCache type spin default 4 min 0 max 1024\n";
+  std::cout << "option name StrategyAsync type check default true\n";
+  std::cout << "option name StrategyBatch type spin default 8 min 1 max 64\n";
+  std::cout << "option name StrategyThreads type spin default 1 min 1 max 64\n";
   std::cout << "option name UseMultiRateThinking type check default true\n";
   std::cout << "option name EnableDistillation type check default false\n";
   std::cout << "option name UsePolicyPruning type check default true\n";
   std::cout << "option name PolicyTopK type spin default 5 min 1 max 32\n";
   std::cout << "option name UseLazyEval type check default true\n";
   std::cout << "option name MasterEvalTopMoves type spin default 3 min 1 max 8\n";
-  std::cout << "option name UseAMXNNUEPath type check default false\n";
+  std::cout << "option name CascadeMaterialMargin type spin default "
+            << engine_components::search_arch::Features{}.cascadeMaterialMargin << " min 0 max 100000\n";
+  std::cout << "option name CascadeDraftMargin type spin default "
+            << engine_components::search_arch::Features{}.cascadeDraftMargin << " min 0 max 100000\n";
+  std::cout << "option name CascadeLopsided type spin default "
+            << engine_components::search_arch::Features{}.cascadeLopsided << " min 0 max 100000\n";
+  std::cout << "option name CascadeSample type check default false\n";
+  std::cout << "option name EvalFile type string default nnue.bin\n";
+  std::cout << "option name StrategyFile type string default strategy_large.nn\n";
+  std::cout << "option name NNUESimd type combo default auto var auto var avx512vnni var avx2 var sse4.1 var scalar\n";
   std::cout << "option name StrategyUseHardPhaseSwitch type check default true\n";
   std::cout << "option name StrategyActiveExperts type spin default 2 min 1 max 2\n";
   std::cout << "option name UseRamTablebase type check default false\n";
   std::cout << "option name AntiCheat type check default false\n";
+  std::cout << "option name EvalParams type string default eval_params.txt\n";
   std::cout << "uciok\n";
 }
 
+// Applies a change to the strategy network or its cache with the inference
+// worker stopped, then drops results computed under the old settings.
+template <typename Change>
+void changeStrategyNet(State& state, Change&& change) {
+  const bool wasRunning = state.strategyService.running();
+  state.strategyService.stop();
+  change();
+  state.strategyCache.clear();
+  if (wasRunning) state.strategyService.start();
+}
+
 void handleSetOption(State& state, const std::string& cmd) {
   std::istringstream iss(cmd);
   std::string token;
@@ -234,7 +284,9 @@ void handleSetOption(State& state, const std::string& cmd) {
     int mb = std::max(1, std::stoi(value));
     state.tt.initialize(static_cast<std::size_t>(mb));
   } else if (name == "Threads") {
-    state.parallel.threads = std::max(1, std::stoi(value));
+    state.parallel.threads = std::clamp(std::stoi(value), 1, 256);
+    state.searchThreads.reset();
+    if (state.parallel.threads > 1) state.searchThreads = std::make_unique<search::SearchThreads>(state.parallel.threads - 1);
   } else if (name == "UseParallelSearch") {
     state.features.useParallel = (value == "true");
   } else if (name == "SplitDepthLimit") {
@@ -265,12 +317,36 @@ void handleSetOption(State& state, const std::string& cmd) {
   } else if (name == "EnableCAT") {
     state.training.cat.enabled = (value == "true");
   } else if (name == "UseStrategyNN") {
-    state.strategyNet.enabled = (value == "true");
+    changeStrategyNet(state, [&] { state.strategyNet.enabled = (value == "true"); });
   } else if (name == "UseBook") {
     state.book.enabled = (value == "true");
   } else if (name == "StrategyPolicyOutputs") {
-    state.strategyNet.cfg.policyOutputs = std::max(64, std::stoi(value));
-    state.strategyNet.load(state.strategyNet.weightsPath);
+    changeStrategyNet(state, [&] {
+      state.strategyNet.cfg.policyOutputs = std::max(64, std::stoi(value));
+      state.strategyNet.load(state.strategyNet.weightsPath);
+    });
+  } else if (name == "StrategyCache") {
+    changeStrategyNet(state, [&] {
+      state.strategyCache.initialize(static_cast<std::size_t>(std::max(0, std::stoi(value))));
+    });
+  } else if (name == "StrategyAsync") {
+    if (value == "true") {
+      state.strategyService.start();
+    } else {
+      state.strategyService.stop();
+    }
+  } else if (name == "StrategyBatch") {
+    changeStrategyNet(state, [&] { state.strategyService.maxBatch = std::clamp(std::stoi(value), 1, 64); });
+  } else if (name == "StrategyThreads") {
+    changeStrategyNet(state, [&] {
+      const int threads = std::clamp(std::stoi(value), 1, 64);
+      state.strategyNet.pool = nullptr;
+      state.strategyPool.reset();
+      if (threads > 1) {
+        state.strategyPool = std::make_unique<engine_components::eval_model::TaskPool>(threads);
+        state.strategyNet.pool = state.strategyPool.get();
+      }
+    });
   } else if (name == "UseMultiRateThinking") {
     state.features.useMultiRateThinking = (value == "true");
   } else if (name == "EnableDistillation") {
@@ -283,17 +359,42 @@ void handleSetOption(State& state, const std::string& cmd) {
     state.features.useLazyEval = (value == "true");
   } else if (name == "MasterEvalTopMoves") {
     state.features.masterEvalTopMoves = std::clamp(std::stoi(value), 1, 8);
-  } else if (name == "UseAMXNNUEPath") {
-    state.nnue.cfg.useAMXPath = (value == "true");
+  } else if (name == "CascadeMaterialMargin") {
+    state.features.cascadeMaterialMargin = std::clamp(std::stoi(value), 0, 100000);
+  } else if (name == "CascadeDraftMargin") {
+    state.features.cascadeDraftMargin = std::clamp(std::stoi(value), 0, 100000);
+  } else if (name == "CascadeLopsided") {
+    state.features.cascadeLopsided = std::clamp(std::stoi(value), 0, 100000);
+  } else if (name == "CascadeSample") {
+    state.cascadeSample = (value == "true");
+  } else if (name == "EvalFile") {
+    if (!state.nnue.load(value)) std::cout << "info string nnue_load_failed " << value << '\n';
+  } else if (name == "StrategyFile") {
+    changeStrategyNet(state, [&] {
+      if (!state.strategyNet.load(value)) std::cout << "info string strategy_load_failed " << value << '\n';
+    });
+  } else if (name == "NNUESimd") {
+    simd::Level level = simd::detect();
+    if ((value != "auto" && !simd::parseLevel(value, level)) || !simd::select(level)) {
+      std::cout << "info string nnue_simd_unsupported " << value << '\n';
+    }
   } else if (name == "StrategyUseHardPhaseSwitch") {
-    state.strategyNet.cfg.useHardPhaseSwitch = (value == "true");
+    changeStrategyNet(state, [&] { state.strategyNet.cfg.useHardPhaseSwitch = (value == "true"); });
   } else if (name == "StrategyActiveExperts") {
-    state.strategyNet.cfg.activeExperts = std::clamp(std::stoi(value), 1, 2);
+    changeStrategyNet(state, [&] { state.strategyNet.cfg.activeExperts = std::clamp(std::stoi(value), 1, 2); });
   } else if (name == "UseRamTablebase") {
     state.ramTablebase.enabled = (value == "true");
     if (state.ramTablebase.enabled && !state.ramTablebase.loaded) state.ramTablebase.preload6ManMock();
   } else if (name == "AntiCheat") {
     state.integrity.antiCheatEnabled = (value == "true");
+  } else if (name == "EvalParams") {
+    eval::Params loaded;
+    if (eval::loadParams(value, loaded)) {
+      state.evalParams = loaded;
+      state.evalParamsPath = value;
+    } else {
+      std::cout << "info string eval params load failed " << value << '\n';
+    }
   }
 }
 
@@ -346,9 +447,11 @@ search::Limits parseGoLimits(State& state, const std::string& cmd) {
   std::istringstream iss(cmd);
   std::string token;
   iss >> token;
+  bool depthGiven = false;
   while (iss >> token) {
     if (token == "depth") {
       iss >> limits.depth;
+      depthGiven = true;
     } else if (token == "movetime") {
       iss >> limits.movetimeMs;
     } else if (token == "infinite") {
@@ -362,10 +465,7 @@ search::Limits parseGoLimits(State& state, const std::string& cmd) {
   if (limits.movetimeMs == 0 && state.timeManager.remainingMs > 0) {
     limits.movetimeMs = state.timeManager.allocateMoveTimeMs(25);
   }
-  if (state.features.useParallel && state.parallel.threads > 1) {
-    const int overhead = std::max(1, state.parallel.threads / 2);
-    limits.movetimeMs = std::max(1, limits.movetimeMs - overhead);
-  }
+  if (!depthGiven && limits.movetimeMs > 0) limits.depth = search::Limits::kMaxDepth;
   return limits;
 }
 
@@ -412,12 +512,53 @@ void handleGo(State& state, const std::string& cmd) {
   state.stopRequested = false;
   const search::Limits limits = parseGoLimits(state, cmd);
 
+  // Lazy SMP: the helpers search the same root into the shared table until
+  // the main thread is done; DeterministicMode searches alone.
+  const int helpers =
+      (state.searchThreads && !state.parallel.deterministicMode) ? state.searchThreads->helpers() : 0;
+  std::vector<search::Result> results(static_cast<std::size_t>(helpers) + 1);
+  std::atomic<bool> helpersStop{false};
+  engine_components::search_arch::CascadeLog* cascadeLog = state.cascadeSample ? &state.cascadeLog : nullptr;
+  const search::SearchThreads::Job helperJob = [&](int index, search::ThreadTables& tables) {
+    search::Searcher helper(state.features, &tables.killer, &tables.history, &tables.counter, &tables.pvTable,
+                            &state.see, nullptr, &state.evalParams, &state.policy, &state.nnue, &state.strategyNet,
+                            state.mcts, state.parallel, &state.tt, &state.strategyCache, &state.strategyService,
+                            cascadeLog);
+    results[static_cast<std::size_t>(index)] = helper.think(state.board, limits, &helpersStop, index);
+  };
+
+  state.tt.nextGeneration();
+  const auto started = std::chrono::steady_clock::now();
+  if (helpers > 0) state.searchThreads->start(helperJob);
   search::Searcher searcher(state.features, &state.killer, &state.history, &state.counter, &state.pvTable, &state.see,
-                            &state.handcrafted, &state.policy, &state.nnue, &state.strategyNet, state.mcts, state.parallel, &state.tt);
-  const search::Result result = searcher.think(state.board, limits, state.rng, &state.stopRequested);
+                            &state.handcrafted, &state.evalParams, &state.policy, &state.nnue, &state.strategyNet, state.mcts, state.parallel, &state.tt,
+                            &state.strategyCache, &state.strategyService, cascadeLog);
+  results[0] = searcher.think(state.board, limits, &state.stopRequested);
+  if (helpers > 0) {
+    helpersStop = true;
+    state.searchThreads->wait();
+  }
+  const long long elapsedMs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+
+  const std::size_t pick = search::selectResult(results);
+  search::Result result = results[pick];
+  result.nodes = 0;
+  for (const auto& r : results) result.nodes += r.nodes;
+  result.evalBreakdown = results[0].evalBreakdown;
+  if (helpers > 0) {
+    result.evalBreakdown += " smp_threads=" + std::to_string(helpers + 1) + " smp_pick=" + std::to_string(pick);
+  }
 
   bool novel = state.prep.novelty.isNovel(key);
-  std::cout << "info depth " << result.depth << " nodes " << result.nodes << " score cp " << result.scoreCp << " pv";
+  std::cout << "info depth " << result.depth << " nodes " << result.nodes << " time " << elapsedMs << " nps "
+            << result.nodes * 1000 / std::max(1LL, elapsedMs) << " score ";
+  if (result.mateIn != 0) {
+    std::cout << "mate " << result.mateIn;
+  } else {
+    std::cout << "cp " << result.scoreCp;
+  }
+  std::cout << " pv";
   for (const auto& move : result.pv) {
     std::cout << ' ' << move.toUCI();
   }
@@ -441,6 +582,348 @@ void handleGo(State& state, const std::string& cmd) {
   state.prep.builder.addLine(key, result.bestMove.toUCI());
 }
 
+// Per-position vs batched throughput for the handcrafted eval and NNUE over
+// positions sampled by random playouts from the current board.
+void handleEvalBench(State& state, const std::string& cmd) {
+  std::istringstream iss(cmd);
+  std::string token;
+  iss >> token;
+  int count = 4096;
+  iss >> count;
+  count = std::clamp(count, 1, 1 << 20);
+
+  std::mt19937 rng(0xBA7C4u);
+  std::vector<board::Board> positions;
+  positions.reserve(static_cast<std::size_t>(count));
+  while (static_cast<int>(positions.size()) < count) {
+    board::Board b = state.board;
+    b.history.clear();
+    for (int ply = 0; ply < 60 && static_cast<int>(positions.size()) < count; ++ply) {
+      const auto legal = movegen::generateLegal(b);
+      if (legal.empty()) break;
+      const auto& mv = legal[rng() % legal.size()];
+      b.applyMove(mv.from, mv.to, mv.promotion);
+      positions.push_back(b);
+    }
+  }
+
+  auto rate = [](std::size_t n, std::chrono::steady_clock::time_point start) {
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<long long>(static_cast<double>(n) / std::max(secs, 1e-9));
+  };
+  std::size_t mismatches = 0;
+  std::vector<int> scores(positions.size());
+  std::vector<int> batched(positions.size());
+
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < positions.size(); ++i) scores[i] = eval::evaluate(positions[i], state.evalParams);
+  const long long hceSingle = rate(positions.size(), start);
+
+  start = std::chrono::steady_clock::now();
+  eval::PositionBatch batch;
+  batch.assign(positions.data(), positions.size());
+  eval::evaluateBatch(batch, state.evalParams, batched.data());
+  const long long hceBatch = rate(positions.size(), start);
+  for (std::size_t i = 0; i < positions.size(); ++i) mismatches += scores[i] != batched[i] ? 1 : 0;
+
+  long long nnueSingle = 0;
+  long long nnueBatch = 0;
+  long long nnueCachedRefresh = 0;
+  int nnueLivePct = 0;
+  long long nnueDraft = 0;
+  long long nnueDraftError = 0;
+  std::string perLevel;
+  const std::size_t nnueCount = std::min<std::size_t>(positions.size(), 64);
+  if (state.nnue.enabled) {
+    start = std::chrono::steady_clock::now();
+    std::vector<engine_components::eval_model::NNUE::Accumulator> accs(nnueCount);
+    for (std::size_t i = 0; i < nnueCount; ++i) {
+      const auto& b = positions[i];
+      state.nnue.initializeAccumulator(accs[i], engine_components::eval_model::NNUE::extractFeatures(b.squares, b.whiteToMove, state.nnue.cfg.inputs));
+      scores[i] = state.nnue.evaluateFromAccumulator(accs[i]);
+    }
+    nnueSingle = rate(nnueCount, start);
+
+    // Consecutive plies through one refresh cache: each refresh only applies
+    // the pieces that changed since the previous position.
+    engine_components::eval_model::NNUE::RefreshCache cache;
+    engine_components::eval_model::NNUE::Accumulator cached;
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < nnueCount; ++i) {
+      state.nnue.refreshAccumulator(cache, positions[i], cached);
+      mismatches += cached.hidden1 != accs[i].hidden1 ? 1 : 0;
+    }
+    nnueCachedRefresh = rate(nnueCount, start);
+
+    // Share of layer-2 input groups the sparse kernel actually visits.
+    std::vector<std::uint8_t> a1(static_cast<std::size_t>(state.nnue.cfg.hidden1));
+    std::size_t liveGroups = 0;
+    for (const auto& acc : accs) {
+      state.nnue.activate(acc.hidden1.data(), a1.data(), state.nnue.cfg.hidden1);
+      for (std::size_t g = 0; g < a1.size(); g += simd::kSparseGroup) {
+        liveGroups += std::any_of(a1.begin() + static_cast<std::ptrdiff_t>(g),
+                                  a1.begin() + static_cast<std::ptrdiff_t>(g + simd::kSparseGroup),
+                                  [](std::uint8_t v) { return v != 0; });
+      }
+    }
+    nnueLivePct = static_cast<int>(liveGroups * 100 * simd::kSparseGroup / (a1.size() * nnueCount));
+
+    // Upper layers alone, per position and as one batch, once per kernel
+    // level the CPU supports; every run must reproduce the scores above.
+    const simd::Level selected = simd::kernels().level;
+    std::vector<const engine_components::eval_model::NNUE::Accumulator*> accPtrs;
+    for (const auto& acc : accs) accPtrs.push_back(&acc);
+    constexpr int kRepeats = 16;
+    for (simd::Level level : {simd::Level::Scalar, simd::Level::SSE41, simd::Level::AVX2, simd::Level::AVX512VNNI}) {
+      if (!simd::select(level)) continue;
+      start = std::chrono::steady_clock::now();
+      for (int r = 0; r < kRepeats; ++r) {
+        for (std::size_t i = 0; i < nnueCount; ++i) batched[i] = state.nnue.evaluateFromAccumulator(accs[i]);
+      }
+      perLevel += std::string(" nnue_layers_") + simd::name(level) + "_pps=" + std::to_string(rate(nnueCount * kRepeats, start));
+      for (std::size_t i = 0; i < nnueCount; ++i) mismatches += scores[i] != batched[i] ? 1 : 0;
+
+      start = std::chrono::steady_clock::now();
+      for (int r = 0; r < kRepeats; ++r) state.nnue.evaluateAccumulators(accPtrs.data(), nnueCount, batched.data());
+      perLevel += std::string(" nnue_layers_batch_") + simd::name(level) + "_pps=" +
+                  std::to_string(rate(nnueCount * kRepeats, start));
+      for (std::size_t i = 0; i < nnueCount; ++i) mismatches += scores[i] != batched[i] ? 1 : 0;
+    }
+    simd::select(selected);
+
+    // Draft head on the same accumulators: its rate against the
+    // nnue_layers_ figure above, and its mean distance from the full score.
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepeats; ++r) {
+      for (std::size_t i = 0; i < nnueCount; ++i) batched[i] = state.nnue.evaluateDraft(accs[i]);
+    }
+    nnueDraft = rate(nnueCount * kRepeats, start);
+    for (std::size_t i = 0; i < nnueCount; ++i) nnueDraftError += std::abs(batched[i] - scores[i]);
+    nnueDraftError /= static_cast<long long>(nnueCount);
+
+    start = std::chrono::steady_clock::now();
+    state.nnue.evaluateBatch(positions.data(), nnueCount, batched.data());
+    nnueBatch = rate(nnueCount, start);
+    for (std::size_t i = 0; i < nnueCount; ++i) mismatches += scores[i] != batched[i] ? 1 : 0;
+  }
+
+  std::cout << "info string evalbench positions=" << positions.size() << " hce_single_pps=" << hceSingle
+            << " hce_batch_pps=" << hceBatch << " nnue_positions=" << nnueCount << " nnue_single_pps=" << nnueSingle
+            << " nnue_batch_pps=" << nnueBatch << " nnue_cached_refresh_pps=" << nnueCachedRefresh
+            << " nnue_l1_live_pct=" << nnueLivePct << " nnue_draft_pps=" << nnueDraft
+            << " nnue_draft_error_cp=" << nnueDraftError << " nnue_simd=" << simd::name(simd::kernels().level) << perLevel
+            << " mismatches=" << mismatches << '\n';
+}
+
+// Per-stage StrategyNet timings over N random positions, once per kernel
+// level the CPU supports, with every policy logit and with the legal moves'
+// logits only; the latter must match the former. Stages run single-threaded;
+// with StrategyThreads > 1 a pass on the pool is timed and compared as well.
+void handleStrategyBench(State& state, const std::string& cmd) {
+  std::istringstream iss(cmd);
+  std::string token;
+  iss >> token;
+  int count = 64;
+  iss >> count;
+  count = std::clamp(count, 1, 1 << 16);
+
+  auto& net = state.strategyNet;
+  if (!net.enabled) {
+    std::cout << "info string strategybench strategy network disabled\n";
+    return;
+  }
+  // The pool is detached for the serial passes, so the worker must be idle.
+  const bool serviceRunning = state.strategyService.running();
+  state.strategyService.stop();
+  engine_components::eval_model::TaskPool* const pool = net.pool;
+  net.pool = nullptr;
+  std::mt19937 rng(0x57A7Eu);
+  std::vector<std::vector<float>> planes;
+  std::vector<std::vector<movegen::Move>> legalMoves;
+  board::Board b = state.board;
+  b.history.clear();
+  while (static_cast<int>(planes.size()) < count) {
+    const auto legal = movegen::generateLegal(b);
+    if (legal.empty()) {
+      b = state.board;
+      b.history.clear();
+      continue;
+    }
+    const auto& mv = legal[rng() % legal.size()];
+    b.applyMove(mv.from, mv.to, mv.promotion);
+    planes.push_back(engine_components::eval_model::StrategyNet::boardPlanes(b.squares, net.cfg.planes));
+    legalMoves.push_back(movegen::generateLegal(b));
+  }
+
+  auto micros = [count](std::chrono::nanoseconds total) {
+    return std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(total).count() / count);
+  };
+  const simd::Level selected = simd::kernels().level;
+  std::string perLevel;
+  std::size_t mismatches = 0;
+  for (simd::Level level : {simd::Level::Scalar, simd::Level::SSE41, simd::Level::AVX2, simd::Level::AVX512VNNI}) {
+    if (!simd::select(level)) continue;
+    engine_components::eval_model::StrategyTimings timings;
+    std::vector<engine_components::eval_model::StrategyOutput> dense;
+    for (const auto& p : planes) dense.push_back(net.evaluate(p, engine_components::eval_model::GamePhase::Middlegame, {}, &timings));
+    const std::string prefix = std::string(" ") + simd::name(level) + "_";
+    perLevel += prefix + "stem_us=" + micros(timings.stem) + prefix + "attention_us=" + micros(timings.attention) +
+                prefix + "experts_us=" + micros(timings.experts) + prefix + "heads_us=" + micros(timings.heads) + prefix +
+                "total_us=" + micros(timings.stem + timings.attention + timings.experts + timings.heads);
+
+    engine_components::eval_model::StrategyTimings legalTimings;
+    for (std::size_t i = 0; i < planes.size(); ++i) {
+      engine_components::eval_model::StrategyQuery query;
+      query.legalMoves = &legalMoves[i];
+      const auto sparse = net.evaluate(planes[i], engine_components::eval_model::GamePhase::Middlegame, query, &legalTimings);
+      for (std::size_t k = 0; k < sparse.policy.size(); ++k) {
+        mismatches += sparse.policy[k] != dense[i].policy[sparse.policyMoves[k]] ? 1 : 0;
+      }
+    }
+    perLevel += prefix + "legal_heads_us=" + micros(legalTimings.heads);
+
+    // Whole network in batches of the inference service's size.
+    std::vector<engine_components::eval_model::StrategyJob> jobs;
+    for (std::size_t i = 0; i < planes.size(); ++i) {
+      jobs.push_back({&planes[i], engine_components::eval_model::GamePhase::Middlegame, {}});
+    }
+    std::vector<engine_components::eval_model::StrategyOutput> batched(jobs.size());
+    const std::size_t batchSize = static_cast<std::size_t>(state.strategyService.maxBatch);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < jobs.size(); i += batchSize) {
+      net.evaluateBatch(&jobs[i], std::min(batchSize, jobs.size() - i), &batched[i]);
+    }
+    perLevel += prefix + "batch" + std::to_string(batchSize) + "_total_us=" +
+                micros(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+    for (std::size_t i = 0; i < jobs.size(); ++i) mismatches += batched[i].policy != dense[i].policy ? 1 : 0;
+
+    if (pool) {
+      net.pool = pool;
+      const auto threadedStart = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < planes.size(); ++i) {
+        const auto threaded = net.evaluate(planes[i], engine_components::eval_model::GamePhase::Middlegame);
+        mismatches += threaded.policy != dense[i].policy || threaded.valueCp != dense[i].valueCp ? 1 : 0;
+      }
+      perLevel += prefix + "threads" + std::to_string(pool->threads()) + "_total_us=" +
+                  micros(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                              threadedStart));
+      net.pool = nullptr;
+    }
+  }
+  simd::select(selected);
+  net.pool = pool;
+  if (serviceRunning) state.strategyService.start();
+  std::cout << "info string strategybench positions=" << count << " params=" << net.parameterCount() << perLevel
+            << " mismatches=" << mismatches << '\n';
+}
+
+// Converts a float nnue.bin into the quantized format, which load() detects
+// by its magic.
+void handleQuantize(State& state, const std::string& cmd) {
+  std::istringstream iss(cmd);
+  std::string token;
+  iss >> token;
+  std::string inPath = state.nnue.weightsPath;
+  std::string outPath = "nnue_q.bin";
+  iss >> inPath >> outPath;
+  if (!std::ifstream(inPath, std::ios::binary)) {
+    std::cout << "info string quantize missing " << inPath << '\n';
+    return;
+  }
+  engine_components::eval_model::NNUE net;
+  net.cfg = state.nnue.cfg;
+  const bool loaded = net.load(inPath);
+  const bool saved = loaded && net.saveQuantized(outPath);
+  std::cout << "info string quantize in=" << inPath << " out=" << outPath << " l2_shift=" << net.l2Shift
+            << " l3_shift=" << net.l3Shift << " saved=" << (saved ? 1 : 0) << '\n';
+}
+
+// Writes the strategy network as a sectioned StrategyNet file, which load()
+// maps and binds section by section.
+void handleStrategyQuantize(State& state, const std::string& cmd) {
+  std::istringstream iss(cmd);
+  std::string token;
+  iss >> token;
+  std::string inPath = state.strategyNet.weightsPath;
+  std::string outPath = "strategy_q.nn";
+  iss >> inPath >> outPath;
+  engine_components::eval_model::StrategyNet net;
+  net.cfg = state.strategyNet.cfg;
+  const bool loaded = net.load(inPath);
+  const bool saved = loaded && net.save(outPath);
+  std::cout << "info string strategyquantize in=" << inPath << " out=" << outPath << " saved=" << (saved ? 1 : 0)
+            << '\n';
+}
+
+// Refits the cascade from the positions searches have logged so far: the
+// material and draft margins cover `coverage` (default 0.99) of their
+// errors, and lopsided material is where the network agrees that often.
+void handleCascadeCalibrate(State& state, const std::string& cmd) {
+  std::istringstream iss(cmd);
+  std::string token;
+  iss >> token;
+  double coverage = 0.99;
+  iss >> coverage;
+  const auto& log = state.cascadeLog;
+  // A handful of samples says nothing about the tails the margins guard.
+  constexpr std::uint64_t kMinSamples = 1000;
+  if (log.samples() < kMinSamples) {
+    std::cout << "info string cascadecalibrate too_few_samples samples=" << log.samples() << " need=" << kMinSamples
+              << " sampling=" << (state.cascadeSample ? "on" : "off") << '\n';
+    return;
+  }
+  state.features.cascadeMaterialMargin = log.margin(engine_components::search_arch::kTierMaterial, coverage);
+  state.features.cascadeDraftMargin = log.margin(engine_components::search_arch::kTierDraft, coverage);
+  state.features.cascadeLopsided = log.lopsided(coverage);
+  std::cout << "info string cascadecalibrate samples=" << log.samples() << " coverage=" << coverage
+            << " material_margin=" << state.features.cascadeMaterialMargin
+            << " draft_margin=" << state.features.cascadeDraftMargin
+            << " lopsided=" << state.features.cascadeLopsided << '\n';
+}
+
+void handleTune(State& state, const std::string& cmd) {
+  tune::Options opts;
+  opts.outPath = state.evalParamsPath;
+  std::istringstream iss(cmd);
+  std::string token;
+  iss >> token;
+  while (iss >> token) {
+    if (token == "data") {
+      iss >> opts.dataPath;
+    } else if (token == "out") {
+      iss >> opts.outPath;
+    } else if (token == "iterations") {
+      iss >> opts.iterations;
+    } else if (token == "threads") {
+      iss >> opts.threads;
+    } else if (token == "lr") {
+      iss >> opts.learningRate;
+    } else if (token == "qplies") {
+      iss >> opts.qsearchPlies;
+    }
+  }
+  if (opts.dataPath.empty()) {
+    std::cout << "info string tune usage: tune data <epd> [out <file>] [iterations N] [threads N] [lr X] [qplies N]\n";
+    return;
+  }
+
+  eval::Params tuned = state.evalParams;
+  const tune::Report report = tune::run(opts, tuned);
+  if (report.positions == 0) {
+    std::cout << "info string tune no positions loaded from " << opts.dataPath << '\n';
+    return;
+  }
+  state.evalParams = tuned;
+  state.tests.params.clear();
+  for (int i = 0; i < eval::kParamCount; ++i) state.tests.params[eval::paramName(i)] = eval::param(tuned, i);
+  state.tests.params["lazyMargin"] = tuned.lazyMargin;
+  std::cout << "info string tune positions=" << report.positions << " skipped=" << report.skipped
+            << " k=" << report.k << " loss=" << report.initialLoss << "->" << report.finalLoss
+            << " load_ms=" << report.loadMs << " tune_ms=" << report.tuneMs
+            << " out=" << opts.outPath << (report.saved ? "" : " (write failed)") << '\n';
+  log(state, "tuned eval params written to " + opts.outPath);
+}
+
 void runLoop(State& state) {
   std::string input;
   while (state.running && std::getline(std::cin, input)) {
@@ -465,8 +948,12 @@ void runLoop(State& state) {
       std::cout << "info string bench movegen_pseudo=" << pseudo
                 << " movegen_legal=" << legal
                 << " nnue_params=" << state.nnue.parameterCount()
+                << " nnue_simd=" << simd::name(simd::kernels().level)
                 << " strategy_params=" << state.strategyNet.parameterCount()
-                << " tt_entries=" << state.tt.entries.size()
+                << " tt_entries=" << state.tt.size()
+                << " strategy_cache_entries=" << state.strategyCache.size()
+                << " strategy_async_evals=" << state.strategyService.evaluated()
+                << " strategy_async_batches=" << state.strategyService.batches()
                 << " mcts_batch=" << state.mcts.miniBatchSize << "\n";
     } else if (input == "buildbook") {
       int imported = 0;
@@ -496,13 +983,7 @@ void runLoop(State& state) {
       state.training.lossLearning.recordLoss();
       state.training.lossLearning.runAdversarialSweep();
       if (state.training.distillationEnabled && state.strategyNet.enabled) {
-        std::vector<float> planes(static_cast<std::size_t>(state.strategyNet.cfg.planes), 0.0f);
-        for (int sq = 0; sq < 64; ++sq) {
-          const char piece = state.board.squares[static_cast<std::size_t>(sq)];
-          if (piece == '.') continue;
-          const int idx = std::min(state.strategyNet.cfg.planes - 1, std::tolower(static_cast<unsigned char>(piece)) - 'a');
-          if (idx >= 0 && idx < state.strategyNet.cfg.planes) planes[static_cast<std::size_t>(idx)] += 1.0f / 8.0f;
-        }
+        const auto planes = engine_components::eval_model::StrategyNet::boardPlanes(state.board.squares, state.strategyNet.cfg.planes);
         int nonPawnMaterial = 0;
         for (char piece : state.board.squares) {
           const char p = static_cast<char>(std::tolower(static_cast<unsigned char>(piece)));
@@ -513,7 +994,9 @@ void runLoop(State& state) {
         const auto phase = nonPawnMaterial >= 36 ? engine_components::eval_model::GamePhase::Opening
                          : nonPawnMaterial >= 16 ? engine_components::eval_model::GamePhase::Middlegame
                                                  : engine_components::eval_model::GamePhase::Endgame;
-        const auto strategy = state.strategyNet.evaluate(planes, phase);
+        engine_components::eval_model::StrategyQuery query;
+        query.heads = engine_components::eval_model::kStrategyValue | engine_components::eval_model::kStrategyPolicy;
+        const auto strategy = state.strategyNet.evaluate(planes, phase, query);
         const float policySignal = strategy.policy.empty() ? 0.0f
             : std::accumulate(strategy.policy.begin(), strategy.policy.end(), 0.0f) / static_cast<float>(strategy.policy.size());
         state.nnue.distillStrategicHint(policySignal, static_cast<float>(strategy.valueCp) / 1000.0f);
@@ -523,8 +1006,23 @@ void runLoop(State& state) {
                 << " distill=" << (state.training.distillationEnabled ? "on" : "off") << '\n';
     } else if (input == "integrity") {
       std::cout << "info string integrity " << (state.integrity.verifyRuntime() ? "ok" : "failed") << '\n';
+    } else if (input.rfind("evalbench", 0) == 0) {
+      handleEvalBench(state, input);
+    } else if (input.rfind("strategybench", 0) == 0) {
+      handleStrategyBench(state, input);
+    } else if (input.rfind("quantize", 0) == 0) {
+      handleQuantize(state, input);
+    } else if (input.rfind("cascadecalibrate", 0) == 0) {
+      handleCascadeCalibrate(state, input);
+    } else if (input.rfind("strategyquantize", 0) == 0) {
+      handleStrategyQuantize(state, input);
+    } else if (input.rfind("tune", 0) == 0) {
+      handleTune(state, input);
     } else if (input == "explain") {
-      std::cout << "info string explain " << state.handcrafted.breakdown() << '\n';
+      eval::Trace trace;
+      const int score = eval::trace(state.board, state.evalParams, trace);
+      state.handcrafted.assign(trace);
+      std::cout << "info string explain eval=" << score << ' ' << state.handcrafted.breakdown() << '\n';
     } else if (input == "features") {
       std::cout << "info string features " << describeFeatures(state) << '\n';
     } else if (input == "quit") {
@@ -536,6 +1034,7 @@ void runLoop(State& state) {
 }
 
 void shutdown(State& state) {
+  state.strategyService.stop();
   state.tt.clear();
   state.cache.save(state.openingCachePath);
   if (state.logFile.is_open()) {
@@ -0,0 +1,70 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define MAPPED_FILE_POSIX 0
+#endif
+
+namespace mapped_file {
+
+namespace {
+
+constexpr std::size_t kAlignment = 64;
+
+std::shared_ptr<const File> readIntoHeap(const std::string& path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) return nullptr;
+  const std::streamoff size = in.tellg();
+  if (size <= 0) return nullptr;
+  auto file = std::make_shared<File>();
+  auto* buffer = static_cast<unsigned char*>(::operator new(static_cast<std::size_t>(size), std::align_val_t(kAlignment)));
+  file->data = buffer;
+  file->size = static_cast<std::size_t>(size);
+  in.seekg(0);
+  if (!in.read(reinterpret_cast<char*>(buffer), size)) return nullptr;
+  return file;
+}
+
+}  // namespace
+
+File::~File() {
+  if (!data) return;
+#if MAPPED_FILE_POSIX
+  if (mapped) {
+    munmap(const_cast<unsigned char*>(data), size);
+    return;
+  }
+#endif
+  ::operator delete(const_cast<unsigned char*>(data), std::align_val_t(kAlignment));
+}
+
+std::shared_ptr<const File> open(const std::string& path) {
+#if MAPPED_FILE_POSIX
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+  struct stat st {};
+  void* p = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);  // the mapping keeps its own reference
+  if (p == MAP_FAILED) return st.st_size > 0 ? readIntoHeap(path) : nullptr;
+  auto file = std::make_shared<File>();
+  file->data = static_cast<const unsigned char*>(p);
+  file->size = static_cast<std::size_t>(st.st_size);
+  file->mapped = true;
+  return file;
+#else
+  return readIntoHeap(path);
+#endif
+}
+
+}  // namespace mapped_file
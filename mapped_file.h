@@ -0,0 +1,30 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace mapped_file {
+
+// Read-only contents of a whole file. On POSIX systems the file is mapped
+// shared, so every process that opens it reads the same page-cache copy;
+// elsewhere it is read into a heap buffer. data is at least 64-byte aligned
+// either way.
+struct File {
+  const unsigned char* data = nullptr;
+  std::size_t size = 0;
+  bool mapped = false;
+
+  File() = default;
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+  ~File();
+};
+
+// Null when the file is missing, empty or unreadable.
+std::shared_ptr<const File> open(const std::string& path);
+
+}  // namespace mapped_file
+
+#endif
@@ -3,23 +3,28 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
-#include <future>
 #include <cctype>
-#include <random>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <numeric>
 #include <thread>
 #include <vector>
 
 #include "board.h"
 #include "engine_components.h"
+#include "eval.h"
 #include "movegen.h"
 #include "tt.h"
 
 namespace search {
 
 struct Limits {
+  // Searches given a time but no depth run to kMaxDepth.
+  static constexpr int kMaxDepth = 64;
   int depth = 3;
   int movetimeMs = 0;
   bool infinite = false;
@@ -31,9 +36,15 @@ struct Result {
   int depth = 0;
   long long nodes = 0;
   int scoreCp = 0;
+  int mateIn = 0;  // moves to a forced mate, negative when being mated, 0 otherwise
   std::vector<movegen::Move> pv;
   std::vector<int> candidateDepths;
   std::string evalBreakdown;
+  // StrategyNet outputs evaluated in place, read back from the
+  // StrategyCache, and handed to the StrategyService.
+  int strategyEvaluations = 0;
+  int strategyCacheHits = 0;
+  int strategyPosted = 0;
 };
 
 class Searcher {
@@ -45,12 +56,16 @@ class Searcher {
            engine_components::search_helpers::PVTable* pvTable,
            engine_components::search_helpers::SEE* see,
            engine_components::eval_model::Handcrafted* handcrafted,
+           const eval::Params* evalParams,
            const engine_components::eval_model::PolicyNet* policy,
            const engine_components::eval_model::NNUE* nnue,
            const engine_components::eval_model::StrategyNet* strategyNet,
            engine_components::search_arch::MCTSConfig mctsCfg,
            engine_components::search_arch::ParallelConfig parallelCfg,
-           tt::Table* tt)
+           tt::Table* tt,
+           engine_components::eval_model::StrategyCache* strategyCache = nullptr,
+           engine_components::eval_model::StrategyService* strategyService = nullptr,
+           engine_components::search_arch::CascadeLog* cascadeLog = nullptr)
       : features_(features),
         killer_(killer),
         history_(history),
@@ -58,29 +73,48 @@ class Searcher {
         pvTable_(pvTable),
         see_(see),
         handcrafted_(handcrafted),
+        evalParams_(evalParams),
         policy_(policy),
         nnue_(nnue),
         strategyNet_(strategyNet),
         mctsCfg_(mctsCfg),
         parallelCfg_(parallelCfg),
-        tt_(tt) {}
+        tt_(tt),
+        strategyCache_(strategyCache),
+        strategyService_(strategyService),
+        cascadeLog_(cascadeLog),
+        useTunedEval_(evalParams && eval::sameWeights(*evalParams, eval::kTunedParams)) {}
 
-  Result think(const board::Board& b, const Limits& limits, std::mt19937& rng, bool* stopFlag) {
+
+  // threadIndex 0 is the main search thread; Lazy SMP helpers are numbered
+  // from 1 and skip iteration depths by their index.
+  Result think(const board::Board& b, const Limits& limits, const std::atomic<bool>* stopFlag, int threadIndex = 0) {
     Result out;
     boardSnapshot_ = b;
-    const auto moves = movegen::generatePseudoLegal(b);
+    boardSnapshot_.enableAttackMaps();
+    rootMoves_ = movegen::generateLegal(b);
+    const auto& moves = rootMoves_;
     nodeCounter_ = 0;
-    strategyCadence_ = std::max(4, limits.depth * 2);
+    stopFlag_ = stopFlag;
+    threadIndex_ = threadIndex;
+    aborted_ = false;
+    hasDeadline_ = limits.movetimeMs > 0 && !limits.infinite;
+    deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.movetimeMs);
     strategyCached_ = false;
+    strategyEvaluations_ = 0;
+    strategyCacheHits_ = 0;
+    strategyPosted_ = 0;
+    pendingStrategyKey_ = 0;
     std::uint64_t occ = 0ULL;
     for (int sq = 0; sq < 64; ++sq) if (boardSnapshot_.squares[static_cast<std::size_t>(sq)] != '.') occ |= (1ULL << sq);
     temporal_.push(occ);
-    if (nnue_ && nnue_->enabled) {
-      const auto nnueFeatures = engine_components::eval_model::NNUE::extractFeatures(boardSnapshot_.squares, boardSnapshot_.whiteToMove, nnue_->cfg.inputs);
-      nnue_->initializeAccumulator(nnueAccumulator_, nnueFeatures);
-    }
-    out.nodes = static_cast<long long>(moves.size()) * 128;
-    out.depth = std::max(1, limits.depth);
+    if (nnue_ && nnue_->enabled) nnueStack_.reset(*nnue_, boardSnapshot_);
+    materialStack_.assign(1, eval::materialPst(boardSnapshot_, materialParams()));
+    keyStack_.assign(1, tt::hash(boardSnapshot_));
+    tierCounts_ = {};
+    cascadeCalls_ = 0;
+    if (killer_) killer_->killer = {};
+    if (pvTable_) pvTable_->length = {};
     if (moves.empty()) {
       return out;
     }
@@ -88,12 +122,18 @@ class Searcher {
     const int count = (features_.useMultiPV && features_.multiPV > 1)
                           ? std::min<int>(features_.multiPV, static_cast<int>(moves.size()))
                           : 1;
-    out.pv.assign(moves.begin(), moves.begin() + count);
 
-    assignCandidateDepths(out, count, out.depth);
-    iterativeDeepening(out, moves, limits, rng, stopFlag);
-    out.ponder = (moves.size() > 1) ? moves[1] : moves[0];
-    if (handcrafted_) {
+    iterativeDeepening(out, moves, limits);
+    out.nodes = static_cast<long long>(nodeCounter_);
+    out.strategyEvaluations = strategyEvaluations_;
+    out.strategyCacheHits = strategyCacheHits_;
+    out.strategyPosted = strategyPosted_;
+    assignCandidateDepths(out, count, std::max(1, out.depth));
+    if (out.pv.size() > 1) out.ponder = out.pv[1];
+    if (handcrafted_ && evalParams_) {
+      eval::Trace trace;
+      eval::trace(boardSnapshot_, *evalParams_, trace);
+      handcrafted_->assign(trace);
       out.evalBreakdown = handcrafted_->breakdown();
     }
     if (nnue_ && nnue_->enabled) {
@@ -101,10 +141,24 @@ class Searcher {
     }
     if (strategyNet_ && strategyNet_->enabled) {
       out.evalBreakdown += " strategy_nn=on(" + std::to_string(strategyNet_->parameterCount()) + ")";
+      out.evalBreakdown += " strategy_evals=" + std::to_string(strategyEvaluations_) +
+                           " strategy_cache_hits=" + std::to_string(strategyCacheHits_) +
+                           " strategy_posted=" + std::to_string(strategyPosted_);
     }
     out.evalBreakdown += " tt_hits=" + std::to_string(ttHits_) + " tt_stores=" + std::to_string(ttStores_);
     out.evalBreakdown += " ab_violations=" + std::to_string(alphaBetaViolations_);
     out.evalBreakdown += " horizon_osc=" + std::to_string(horizonOscillations_);
+    out.evalBreakdown += " lazy_calls=" + std::to_string(lazyStats_.calls) + " lazy_exit_pct=" +
+                         std::to_string(static_cast<int>(std::lround(lazyStats_.earlyExitRate() * 100.0))) +
+                         " lazy_max_pos=" + std::to_string(lazyStats_.maxPositional);
+    const std::uint64_t tierEvals = std::accumulate(tierCounts_.begin(), tierCounts_.end(), std::uint64_t{0});
+    auto tierPct = [&](int tier) {
+      return std::to_string(tierEvals ? tierCounts_[static_cast<std::size_t>(tier)] * 100 / tierEvals : 0);
+    };
+    out.evalBreakdown += " tier_evals=" + std::to_string(tierEvals) +
+                         " tier_material_pct=" + tierPct(engine_components::search_arch::kTierMaterial) +
+                         " tier_draft_pct=" + tierPct(engine_components::search_arch::kTierDraft) +
+                         " tier_full_pct=" + tierPct(engine_components::search_arch::kTierFull);
     return out;
   }
 
@@ -116,25 +170,75 @@ class Searcher {
   engine_components::search_helpers::PVTable* pvTable_;
   engine_components::search_helpers::SEE* see_;
   engine_components::eval_model::Handcrafted* handcrafted_;
+  const eval::Params* evalParams_ = nullptr;
   const engine_components::eval_model::PolicyNet* policy_;
   const engine_components::eval_model::NNUE* nnue_;
   const engine_components::eval_model::StrategyNet* strategyNet_;
   engine_components::search_arch::MCTSConfig mctsCfg_{};
   engine_components::search_arch::ParallelConfig parallelCfg_{};
   tt::Table* tt_ = nullptr;
+  engine_components::eval_model::StrategyCache* strategyCache_ = nullptr;
+  engine_components::eval_model::StrategyService* strategyService_ = nullptr;
+  engine_components::search_arch::CascadeLog* cascadeLog_ = nullptr;
+  bool useTunedEval_ = false;  // compile-time Params instantiation when nothing was loaded over them
   int alphaBetaViolations_ = 0;
   int ttHits_ = 0;
   int ttStores_ = 0;
   int horizonOscillations_ = 0;
+  eval::LazyStats lazyStats_{};
+  // The position being searched; make/unmake walk it through the tree.
   board::Board boardSnapshot_{};
+  std::vector<movegen::Move> rootMoves_;
+  mutable std::vector<movegen::Move> strategyMoves_;
   std::size_t nodeCounter_ = 0;
-  int strategyCadence_ = 8;
+  // Last StrategyCache record read, decoded, and the key it belongs to.
   mutable engine_components::eval_model::StrategyOutput cachedStrategy_{};
+  mutable engine_components::eval_model::StrategyOutput strategyScratch_{};
+  mutable std::uint64_t cachedStrategyKey_ = 0;
   mutable bool strategyCached_ = false;
-  mutable engine_components::eval_model::NNUE::Accumulator nnueAccumulator_{};
+  mutable int strategyEvaluations_ = 0;
+  mutable int strategyCacheHits_ = 0;
+  mutable int strategyPosted_ = 0;
+  // Key last handed to strategyService_; until its result lands in the
+  // cache, getStrategyOutput() answers with a neutral output.
+  mutable std::uint64_t pendingStrategyKey_ = 0;
+  const engine_components::eval_model::StrategyOutput neutralStrategy_{};
+  // One accumulator per ply of boardSnapshot_, pushed and popped alongside
+  // make/unmake; entries are only computed when a node evaluates.
+  engine_components::eval_model::NNUE::AccumulatorStack nnueStack_{};
+  // White-relative material + PST per ply, pushed and popped with nnueStack_.
+  mutable std::vector<int> materialStack_;
+  // tt::hash() of every position from the root to the current node.
+  std::vector<std::uint64_t> keyStack_;
+  // Move played into each ply, for the counter-move table; from < 0 after a
+  // null move.
+  std::array<movegen::Move, 128> playedMoves_{};
+  // Evaluations each cascade tier answered; every kCascadeSampleEvery-th
+  // cascade call also logs all three tiers to cascadeLog_.
+  static constexpr std::uint64_t kCascadeSampleEvery = 32;
+  mutable std::array<std::uint64_t, engine_components::search_arch::kTierCount> tierCounts_{};
+  mutable std::uint64_t cascadeCalls_ = 0;
   engine_components::representation::TemporalBitboard temporal_{};
-  movegen::Move lastBestMove_{};
-  int lastIterationScore_ = 0;
+  // Set once the stop flag or the deadline is seen; the iteration in
+  // progress is then discarded.
+  const std::atomic<bool>* stopFlag_ = nullptr;
+  int threadIndex_ = 0;
+  bool aborted_ = false;
+  bool hasDeadline_ = false;
+  std::chrono::steady_clock::time_point deadline_{};
+
+  // Plies are bounded by the killer and PV tables. Mate scores count down
+  // from kMate by the ply they are found at.
+  static constexpr int kMaxPly = 128;
+  static constexpr int kInfinity = 32000;
+  static constexpr int kMate = 31000;
+  static constexpr int kMateBound = kMate - kMaxPly;
+  static constexpr int kAspirationWindow = 50;
+  // Ceiling of the history scores; bonuses shrink as an entry nears it.
+  static constexpr int kHistoryMax = 16384;
+  // Only full-tier evaluations this close to the root add the strategy
+  // network's value terms; anywhere deeper it would dominate the node rate.
+  static constexpr int kStrategyPlies = 2;
 
   void assignCandidateDepths(Result& out, int candidateCount, int rootDepth) const {
     out.candidateDepths.assign(candidateCount, rootDepth);
@@ -179,6 +283,26 @@ class Searcher {
            b.history[n - 3] == b.history[n - 7] && b.history[n - 4] == b.history[n - 8];
   }
 
+  // The current node repeats a position earlier on the search path since
+  // the last capture or pawn move.
+  bool isPathRepetition() const {
+    const std::size_t top = keyStack_.size() - 1;
+    const std::size_t window = std::min<std::size_t>(top, static_cast<std::size_t>(boardSnapshot_.halfmoveClock));
+    for (std::size_t back = 4; back <= window; back += 2) {
+      if (keyStack_[top - back] == keyStack_[top]) return true;
+    }
+    return false;
+  }
+
+  static bool hasNonPawnMaterial(const board::Board& b, bool white) {
+    for (char piece : b.squares) {
+      if (piece == '.' || (std::isupper(static_cast<unsigned char>(piece)) != 0) != white) continue;
+      const char p = static_cast<char>(std::tolower(static_cast<unsigned char>(piece)));
+      if (p != 'p' && p != 'k') return true;
+    }
+    return false;
+  }
+
   int cladeId(const movegen::Move& m) const {
     const int df = std::abs((m.to % 8) - (m.from % 8));
     const int dr = std::abs((m.to / 8) - (m.from / 8));
@@ -190,7 +314,7 @@ class Searcher {
 
   float m2ctsPhaseMixScore(int depth) const {
     if (!(features_.useMCTS && mctsCfg_.usePhaseAwareM2CTS && strategyNet_ && strategyNet_->enabled)) return 0.0f;
-    const auto& out = getStrategyOutput(false);
+    const auto& out = getStrategyOutput();
     const float opening = out.expertMix[0];
     const float middle = out.expertMix[1];
     const float ending = out.expertMix[2];
@@ -204,118 +328,390 @@ class Searcher {
     return orderingScore - static_cast<int>(virtualLoss);
   }
 
-  void iterativeDeepening(Result& out, const std::vector<movegen::Move>& moves, const Limits& limits, std::mt19937& rng,
-                          bool* stopFlag) {
-    std::uniform_int_distribution<std::size_t> d(0, moves.size() - 1);
-    int alpha = -30000;
-    int beta = 30000;
-    out.bestMove = parallelCfg_.deterministicMode ? moves.front() : moves[d(rng)];
+  // Polls the stop flag and the deadline every 1024 nodes.
+  bool shouldStop() {
+    if (aborted_) return true;
+    if ((nodeCounter_ & 1023) != 0) return false;
+    if ((stopFlag_ && stopFlag_->load(std::memory_order_relaxed)) ||
+        (hasDeadline_ && std::chrono::steady_clock::now() >= deadline_)) {
+      aborted_ = true;
+    }
+    return aborted_;
+  }
 
-    for (int depth = 1; depth <= out.depth; ++depth) {
-      if (stopFlag && *stopFlag) break;
-      if (limits.movetimeMs > 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(2, limits.movetimeMs)));
+  void iterativeDeepening(Result& out, const std::vector<movegen::Move>& moves, const Limits& limits) {
+    // Root moves are ordered once by their heuristic bias plus a batched
+    // NNUE look at each child; after that every iteration moves its best
+    // move to the front.
+    std::vector<std::pair<int, movegen::Move>> ordered;
+    ordered.reserve(moves.size());
+    for (const auto& m : moves) ordered.push_back({0, m});
+    const std::vector<int> scouts = scoutScores(ordered, ordered.size(), 0);
+    for (std::size_t i = 0; i < ordered.size(); ++i) ordered[i].first = scouts[i];
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+    out.bestMove = ordered.front().second;
+    out.pv = {out.bestMove};
+
+    // Policy pruning: root moves past the policy's top K (or past the first
+    // when the policy is confident) are searched one ply shallower unless
+    // they beat the best score so far.
+    int keep = static_cast<int>(ordered.size());
+    if (features_.usePolicyPruning) {
+      keep = std::max(1, std::min(features_.policyTopK, keep));
+      if (strategyNet_ && strategyNet_->enabled) {
+        const auto& sOut = getStrategyOutput();
+        if (!sOut.policy.empty()) {
+          // Over every root move: the cached record keeps only the best
+          // logits, and the rest read its floor.
+          std::vector<float> logits;
+          logits.reserve(rootMoves_.size());
+          for (const auto& m : rootMoves_) logits.push_back(sOut.policyLogit(strategyNet_->policyIndex(m)));
+          const float maxLogit = *std::max_element(logits.begin(), logits.end());
+          float sumExp = 0.0f;
+          for (float logit : logits) sumExp += std::exp(logit - maxLogit);
+          const float topProb = 1.0f / std::max(1e-6f, sumExp);
+          if (topProb >= features_.policyPruneThreshold) keep = 1;
+        }
       }
+    }
 
-      int score = alphaBeta(depth, alpha, beta);
-      if (strategyNet_ && strategyNet_->enabled) strategyCached_ = false;
-      if (features_.useAspiration) {
-        alpha = score - 50;
-        beta = score + 50;
+    const int maxDepth = std::clamp(limits.depth, 1, kMaxPly - 1);
+    int previous = 0;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+      if (skipsDepth(depth, maxDepth)) continue;
+      int delta = kAspirationWindow;
+      int alpha = -kInfinity;
+      int beta = kInfinity;
+      if (features_.useAspiration && depth >= 4 && std::abs(previous) < kMateBound) {
+        alpha = previous - delta;
+        beta = previous + delta;
+      }
+      int score = 0;
+      while (true) {
+        score = searchRoot(ordered, depth, alpha, beta, keep);
+        if (aborted_) break;
+        if (score <= alpha) {
+          alpha = std::max(-kInfinity, alpha - delta);
+        } else if (score >= beta) {
+          beta = std::min(kInfinity, beta + delta);
+        } else {
+          break;
+        }
+        delta *= 2;
       }
+      if (aborted_) break;
+
+      previous = score;
+      out.depth = depth;
       out.scoreCp = score;
-      std::vector<std::pair<int, movegen::Move>> ordered;
-      ordered.reserve(moves.size());
-      for (const auto& m : moves) {
-        ordered.push_back({moveOrderingBias(m, depth), m});
+      out.mateIn = score >= kMateBound ? (kMate - score + 1) / 2 : score <= -kMateBound ? -(kMate + score) / 2 : 0;
+      out.bestMove = ordered.front().second;
+      out.pv = {out.bestMove};
+      if (pvTable_ && pvTable_->length[0] > 0 && pvTable_->pv[0][0] == out.bestMove) {
+        out.pv.assign(pvTable_->pv[0].begin(), pvTable_->pv[0].begin() + pvTable_->length[0]);
       }
-      std::sort(ordered.begin(), ordered.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
-      if (features_.usePolicyPruning) {
-        int keep = std::max(1, std::min(features_.policyTopK, static_cast<int>(ordered.size())));
-        if (strategyNet_ && strategyNet_->enabled) {
-          const auto& sOut = getStrategyOutput(false);
-          if (!sOut.policy.empty()) {
-            const float maxLogit = *std::max_element(sOut.policy.begin(), sOut.policy.end());
-            float sumExp = 0.0f;
-            for (float logit : sOut.policy) sumExp += std::exp(logit - maxLogit);
-            const float topProb = 1.0f / std::max(1e-6f, sumExp);
-            if (topProb >= features_.policyPruneThreshold) keep = 1;
-          }
+      if (std::abs(score) >= kMateBound) break;  // a forced mate only gets longer
+    }
+  }
+
+  // Lazy SMP depth staggering: helpers skip iterations in blocks of a size
+  // and phase picked by their index, so at any moment the threads are
+  // spread over neighbouring depths instead of all repeating one. The main
+  // thread, depth 1 and the last depth are never skipped.
+  bool skipsDepth(int depth, int maxDepth) const {
+    static constexpr std::array<int, 20> kSkipSize{1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+    static constexpr std::array<int, 20> kSkipPhase{0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+    if (threadIndex_ == 0 || depth == 1 || depth == maxDepth) return false;
+    const std::size_t i = static_cast<std::size_t>((threadIndex_ - 1) % 20);
+    return ((depth + kSkipPhase[i]) / kSkipSize[i]) % 2 != 0;
+  }
+
+  // PVS over the root moves in `ordered`, which must all be legal. The best
+  // move is moved to the front when it raised alpha.
+  int searchRoot(std::vector<std::pair<int, movegen::Move>>& ordered, int depth, int alpha, int beta, int keep) {
+    ++nodeCounter_;
+    if (pvTable_) pvTable_->length[0] = 0;
+    const int alphaOrig = alpha;
+    const bool inCheck = boardSnapshot_.inCheck(boardSnapshot_.whiteToMove);
+    const int masterCount = std::max(1, features_.masterEvalTopMoves);
+    int best = -kInfinity;
+    std::size_t bestIndex = 0;
+    for (std::size_t i = 0; i < ordered.size(); ++i) {
+      const movegen::Move move = ordered[i].second;
+      const bool quiet = boardSnapshot_.squares[static_cast<std::size_t>(move.to)] == '.' && move.promotion == '\0';
+      board::Undo undo;
+      if (!makeMove(move, 0, undo)) continue;
+      const bool givesCheck = boardSnapshot_.inCheck(boardSnapshot_.whiteToMove);
+      const int newDepth = depth - 1 + (features_.useExtensions && givesCheck ? 1 : 0);
+      int reduction = 0;
+      if (static_cast<int>(i) >= masterCount && quiet && !inCheck && !givesCheck) {
+        reduction = lateMoveReduction(depth, static_cast<int>(i));
+      }
+      if (static_cast<int>(i) >= keep) ++reduction;
+      const int score = searchChild(static_cast<int>(i), newDepth, std::min(reduction, newDepth), 0, alpha, beta);
+      unmakeMove(move, undo);
+      if (aborted_) return best;
+
+      if (score > best) {
+        best = score;
+        bestIndex = i;
+        if (score > alpha) {
+          alpha = score;
+          updatePv(0, move);
+          if (alpha >= beta) break;
         }
-        ordered.resize(static_cast<std::size_t>(keep));
       }
+    }
+    if (best > alphaOrig) std::rotate(ordered.begin(), ordered.begin() + static_cast<std::ptrdiff_t>(bestIndex),
+                                      ordered.begin() + static_cast<std::ptrdiff_t>(bestIndex) + 1);
+    return best;
+  }
 
+  // One move's subtree for the node at `ply`, after the move is made: the
+  // first move gets the full window; later ones a reduced null window (a
+  // reduced full window without usePVS), re-searched at full depth and
+  // then with the full window while they keep beating alpha.
+  int searchChild(int index, int newDepth, int reduction, int ply, int alpha, int beta) {
+    if (index == 0) return -alphaBeta(newDepth, ply + 1, -beta, -alpha, true);
+    const int scoutBeta = features_.usePVS ? alpha + 1 : beta;
+    int score = -alphaBeta(newDepth - reduction, ply + 1, -scoutBeta, -alpha, true);
+    if (score > alpha && reduction > 0) score = -alphaBeta(newDepth, ply + 1, -scoutBeta, -alpha, true);
+    if (score > alpha && score < beta && scoutBeta != beta) score = -alphaBeta(newDepth, ply + 1, -beta, -alpha, true);
+    return score;
+  }
 
-      std::vector<std::future<int>> scouts;
-      const int scoutCount = std::min(7, static_cast<int>(ordered.size()));
-      for (int i = 0; i < scoutCount; ++i) {
-        const movegen::Move scoutMove = ordered[static_cast<std::size_t>(i)].second;
-        scouts.push_back(std::async(std::launch::async, [this, scoutMove, depth]() {
-          return evaluateMoveLazy(scoutMove, depth + 1, true);
-        }));
+  // Plies a late quiet move loses, growing with depth and move number.
+  int lateMoveReduction(int depth, int index) const {
+    if (!features_.useLMR || depth < 3 || index < 3) return 0;
+    static const auto table = [] {
+      std::array<std::array<int, 64>, 64> t{};
+      for (int d = 1; d < 64; ++d) {
+        for (int i = 1; i < 64; ++i) {
+          t[static_cast<std::size_t>(d)][static_cast<std::size_t>(i)] =
+              static_cast<int>(0.75 + std::log(static_cast<double>(d)) * std::log(static_cast<double>(i)) / 2.25);
+        }
       }
+      return t;
+    }();
+    return std::max(1, table[static_cast<std::size_t>(std::min(depth, 63))][static_cast<std::size_t>(std::min(index, 63))]);
+  }
 
-      int bestScore = -300000;
-      out.bestMove = ordered.empty() ? moves[d(rng)] : ordered.front().second;
-      const int masterCount = std::max(1, std::min(features_.masterEvalTopMoves, static_cast<int>(ordered.size())));
-      for (std::size_t i = 0; i < ordered.size(); ++i) {
-        const bool useMaster = !features_.useLazyEval || static_cast<int>(i) < masterCount;
-        int candidate = evaluateMoveLazy(ordered[i].second, depth, useMaster);
-        if (i < scouts.size()) {
-          candidate = std::max(candidate, scouts[i].get());
-        }
-        if (candidate > bestScore) {
-          bestScore = candidate;
-          out.bestMove = ordered[i].second;
+  static int scoreToTT(int score, int ply) {
+    if (score >= kMateBound) return score + ply;
+    if (score <= -kMateBound) return score - ply;
+    return score;
+  }
+
+  static int scoreFromTT(int score, int ply) {
+    if (score >= kMateBound) return score - ply;
+    if (score <= -kMateBound) return score + ply;
+    return score;
+  }
+
+  int alphaBeta(int depth, int ply, int alpha, int beta, bool allowNull) {
+    if (pvTable_) pvTable_->length[static_cast<std::size_t>(ply)] = ply;
+    if (depth <= 0) return quiescence(ply, alpha, beta, 0);
+    if (shouldStop()) return 0;
+    ++nodeCounter_;
+
+    if (boardSnapshot_.halfmoveClock >= 100 || isInsufficientMaterial(boardSnapshot_) || isPathRepetition()) {
+      return 0;
+    }
+    if (features_.useMateDistancePruning) {
+      alpha = std::max(alpha, -kMate + ply);
+      beta = std::min(beta, kMate - ply - 1);
+      if (alpha >= beta) return alpha;
+    }
+    if (ply >= kMaxPly - 1) return evaluateNode(ply, depth, alpha, beta, engine_components::search_arch::kTierFull);
+
+    const bool pvNode = beta - alpha > 1;
+    const std::uint64_t key = keyStack_.back();
+    movegen::Move ttMove;
+    tt::Entry entry;
+    if (tt_ && tt_->probe(key, entry)) {
+      ttMove = entry.move;
+      if (!pvNode && entry.depth >= depth) {
+        const int ttScore = scoreFromTT(entry.score, ply);
+        if (entry.bound == tt::Bound::Exact || (entry.bound == tt::Bound::Lower && ttScore >= beta) ||
+            (entry.bound == tt::Bound::Upper && ttScore <= alpha)) {
+          ++ttHits_;
+          return ttScore;
         }
       }
-      out.nodes += depth * 1000;
+    }
 
-      if (out.bestMove.from == lastBestMove_.from && out.bestMove.to == lastBestMove_.to &&
-          out.bestMove.promotion == lastBestMove_.promotion) {
-        out.scoreCp += 6;  // PV anchoring bonus when best line remains stable
+    const bool inCheck = boardSnapshot_.inCheck(boardSnapshot_.whiteToMove);
+    const int staticScore =
+        inCheck ? -kInfinity : evaluateNode(ply, depth, alpha, beta, engine_components::search_arch::kTierFull);
+    if (!pvNode && !inCheck) {
+      // Reverse futility: far enough above beta that a shallow search will
+      // not come back under it.
+      if (features_.useFutility && depth <= 3 && staticScore - 120 * depth >= beta) return staticScore;
+      if (features_.useNullMove && allowNull && depth >= 3 && staticScore >= beta &&
+          hasNonPawnMaterial(boardSnapshot_, boardSnapshot_.whiteToMove)) {
+        const int r = 2 + depth / 6;
+        const NullUndo undo = makeNullMove(ply);
+        const int score = -alphaBeta(depth - 1 - r, ply + 1, -beta, -beta + 1, false);
+        unmakeNullMove(undo);
+        if (aborted_) return 0;
+        if (score >= beta) return score >= kMateBound ? beta : score;
       }
-      lastBestMove_ = out.bestMove;
-      lastIterationScore_ = out.scoreCp;
+    }
 
-      updateHeuristics(depth, out.bestMove);
+    std::vector<movegen::Move> moves = movegen::generatePseudoLegal(boardSnapshot_);
+    std::vector<int> order(moves.size());
+    const movegen::Move& previous = playedMoves_[static_cast<std::size_t>(ply)];
+    const movegen::Move counterMove =
+        (counter_ && previous.from >= 0) ? counter_->counter[static_cast<std::size_t>(previous.from)]
+                                                            [static_cast<std::size_t>(previous.to)]
+                                         : movegen::Move{};
+    for (std::size_t i = 0; i < moves.size(); ++i) order[i] = orderScore(moves[i], ply, ttMove, counterMove);
+
+    const int alphaOrig = alpha;
+    const bool frontier = features_.useFutility && !pvNode && !inCheck && depth <= 2 &&
+                          staticScore + 100 + 150 * depth <= alpha;
+    std::array<movegen::Move, 64> quietsTried;
+    int quietCount = 0;
+    int legal = 0;
+    int best = -kInfinity;
+    movegen::Move bestMove;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+      // Selection sort: most nodes cut off after a move or two.
+      const std::size_t pick = static_cast<std::size_t>(
+          std::max_element(order.begin() + static_cast<std::ptrdiff_t>(i), order.end()) - order.begin());
+      std::swap(moves[i], moves[pick]);
+      std::swap(order[i], order[pick]);
+      const movegen::Move move = moves[i];
+      const bool quiet = boardSnapshot_.squares[static_cast<std::size_t>(move.to)] == '.' && move.promotion == '\0';
+
+      board::Undo undo;
+      if (!makeMove(move, ply, undo)) continue;
+      const int index = legal++;
+      const bool givesCheck = boardSnapshot_.inCheck(boardSnapshot_.whiteToMove);
+      if (frontier && index > 0 && quiet && !givesCheck) {
+        unmakeMove(move, undo);
+        continue;
+      }
+      const int newDepth = depth - 1 + (features_.useExtensions && givesCheck ? 1 : 0);
+      const int reduction =
+          (quiet && !inCheck && !givesCheck) ? std::min(lateMoveReduction(depth, index), newDepth) : 0;
+      const int score = searchChild(index, newDepth, reduction, ply, alpha, beta);
+      unmakeMove(move, undo);
+      if (aborted_) return 0;
 
-      if (limits.infinite) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if (score > best) {
+        best = score;
+        bestMove = move;
+        if (score > alpha) {
+          alpha = score;
+          updatePv(ply, move);
+          if (alpha >= beta) {
+            if (quiet) recordCutoff(move, ply, depth, quietsTried.data(), quietCount);
+            break;
+          }
+        }
       }
+      if (quiet && quietCount < static_cast<int>(quietsTried.size())) quietsTried[static_cast<std::size_t>(quietCount++)] = move;
     }
+
+    if (legal == 0) return inCheck ? -kMate + ply : 0;
+    if (best == -kInfinity) return alpha;  // every move was futility-pruned
+
+    if (tt_) {
+      const tt::Bound bound =
+          best >= beta ? tt::Bound::Lower : (best > alphaOrig ? tt::Bound::Exact : tt::Bound::Upper);
+      tt_->store(key, depth, scoreToTT(best, ply), bound, bestMove);
+      ++ttStores_;
+    }
+    return best;
   }
 
-  int alphaBeta(int depth, int alpha, int beta) {
-    const int alphaOrig = alpha;
-    const int betaOrig = beta;
-    if (alpha > beta) {
-      ++alphaBetaViolations_;
-      std::swap(alpha, beta);
+  int quiescence(int ply, int alpha, int beta, int qdepth) {
+    if (pvTable_) pvTable_->length[static_cast<std::size_t>(ply)] = ply;
+    if (shouldStop()) return 0;
+    ++nodeCounter_;
+    // The horizon node is scored in full; capture sequences below it never
+    // go past the draft head.
+    const auto ceiling =
+        qdepth == 0 ? engine_components::search_arch::kTierFull : engine_components::search_arch::kTierDraft;
+    if (!features_.useQuiescence || ply >= kMaxPly - 1) return evaluateNode(ply, 0, alpha, beta, ceiling);
+
+    const bool inCheck = boardSnapshot_.inCheck(boardSnapshot_.whiteToMove);
+    int best = -kInfinity;
+    int standPat = -kInfinity;
+    if (!inCheck) {
+      standPat = evaluateNode(ply, 0, alpha, beta, ceiling);
+      if (standPat >= beta) return standPat;
+      alpha = std::max(alpha, standPat);
+      best = standPat;
     }
-    if (depth <= 0) {
-      return features_.useQuiescence ? quiescence(alpha, beta) : 0;
+
+    // Captures and promotions only, unless in check: then every evasion.
+    const int deltaMargin = 96;
+    std::vector<movegen::Move> moves = movegen::generatePseudoLegal(boardSnapshot_);
+    std::vector<int> order;
+    order.reserve(moves.size());
+    std::size_t kept = 0;
+    for (const auto& mv : moves) {
+      const bool isCapture = boardSnapshot_.squares[static_cast<std::size_t>(mv.to)] != '.';
+      const bool isPromotion = mv.promotion != '\0';
+      if (!inCheck) {
+        if (!isCapture && !isPromotion) continue;
+        const int seeScore = see_ ? see_->estimate(mv, boardSnapshot_) : 0;
+        if (isCapture && seeScore < -80 && !isPromotion) continue;
+        if (standPat + seeScore + deltaMargin < alpha && !isPromotion) continue;
+        order.push_back(seeScore);
+      } else {
+        order.push_back(orderScore(mv, ply, movegen::Move{}, movegen::Move{}));
+      }
+      moves[kept++] = mv;
     }
+    moves.resize(kept);
 
-    ++nodeCounter_;
-    int score = 20 * depth;
-    if (features_.usePVS) score += 2;
-    if (features_.useNullMove) score += 1;
-    if (features_.useLMR) score += 1;
-    if (features_.useFutility) score += 1;
-    if (features_.useMateDistancePruning) score += 1;
-    if (features_.useExtensions) score += 1;
-    if (handcrafted_) score += handcrafted_->score() / 100;
+    int legal = 0;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+      const std::size_t pick = static_cast<std::size_t>(
+          std::max_element(order.begin() + static_cast<std::ptrdiff_t>(i), order.end()) - order.begin());
+      std::swap(moves[i], moves[pick]);
+      std::swap(order[i], order[pick]);
+      const movegen::Move move = moves[i];
+      board::Undo undo;
+      if (!makeMove(move, ply, undo)) continue;
+      ++legal;
+      const int score = -quiescence(ply + 1, -beta, -alpha, qdepth + 1);
+      unmakeMove(move, undo);
+      if (aborted_) return 0;
+      if (score > best) {
+        best = score;
+        if (score > alpha) {
+          alpha = score;
+          updatePv(ply, move);
+          if (alpha >= beta) break;
+        }
+      }
+    }
+    if (inCheck && legal == 0) return -kMate + ply;
+    return best;
+  }
+
+  // Heuristic score of a position from the side to move: the handcrafted
+  // evaluation, the NNUE through the evaluation cascade and, on full-tier
+  // evaluations near the root, the strategy network's value terms.
+  int evaluateNode(int ply, int depth, int alpha, int beta, engine_components::search_arch::EvalTier ceiling) {
+    int score = 0;
+    if (evalParams_) score += staticEval(boardSnapshot_, alpha, beta);
+    auto tier = engine_components::search_arch::kTierFull;
     if (nnue_ && nnue_->enabled) {
-      const std::vector<float> nnueFeatures = engine_components::eval_model::NNUE::extractFeatures(
-          boardSnapshot_.squares, boardSnapshot_.whiteToMove, nnue_->cfg.inputs);
-      score += nnue_->evaluate(nnueFeatures) / 16;
+      // The network counts 1/16 here, so its window is the node's scaled up.
+      score += cascadeEval(boardSnapshot_, nnueStack_, 16 * (alpha - score), 16 * (beta - score), ceiling, tier) / 16;
     }
 
-    const bool runStrategyNow = strategyNet_ && strategyNet_->enabled &&
-                                (depth >= std::max(1, strategyCadence_ / 4) || nodeCounter_ % static_cast<std::size_t>(strategyCadence_) == 0);
+    // The strategy network is the most expensive term: full-tier nodes only.
+    const bool runStrategyNow = tier == engine_components::search_arch::kTierFull && ply < kStrategyPlies &&
+                                strategyNet_ && strategyNet_->enabled;
     if (runStrategyNow) {
-      const engine_components::eval_model::StrategyOutput& out = getStrategyOutput(true);
+      const engine_components::eval_model::StrategyOutput& out = getStrategyOutput();
       const float tacticalDelta = out.tacticalThreat[0] - out.tacticalThreat[1];
       const float kingDelta = out.kingSafety[0] - out.kingSafety[1];
       const float mobilityDelta = out.mobility[0] - out.mobility[1];
@@ -324,80 +720,121 @@ class Searcher {
       score += static_cast<int>(mobilityDelta * 8.0f);
       score -= strategicAsymmetricPrunePenalty(out, depth);
     }
-    int bounded = std::clamp(score, alpha, beta);
-    if (tt_) {
-      std::uint64_t key = 1469598103934665603ULL;
-      for (char piece : boardSnapshot_.squares) {
-        key ^= static_cast<std::uint64_t>(static_cast<unsigned char>(piece));
-        key *= 1099511628211ULL;
-      }
-      key ^= boardSnapshot_.whiteToMove ? 0x9e3779b97f4a7c15ULL : 0ULL;
-      tt::Bound bnd = tt::Bound::Exact;
-      if (bounded <= alphaOrig) bnd = tt::Bound::Upper;
-      else if (bounded >= betaOrig) bnd = tt::Bound::Lower;
-      tt_->store(key, depth, bounded, bnd);
-      ++ttStores_;
-    }
-    return bounded;
+    return std::clamp(score, -kMateBound + 1, kMateBound - 1);
   }
 
-  int quiescence(int alpha, int beta) const {
-    int standPat = 0;
-    if (see_) {
-      movegen::Move dummy;
-      standPat += see_->estimate(dummy, &boardSnapshot_.squares);
+  // The static eval is compared against the window net of any heuristic terms
+  // the caller already added.
+  int staticEval(const board::Board& b, int alpha, int beta) {
+    if (useTunedEval_) {
+      return features_.useLazyEval ? eval::evaluateTuned(b, alpha, beta, &lazyStats_) : eval::evaluateTuned(b);
     }
+    return features_.useLazyEval ? eval::evaluate(b, *evalParams_, alpha, beta, &lazyStats_) : eval::evaluate(b, *evalParams_);
+  }
 
-    if (nnue_ && nnue_->enabled && !nnueAccumulator_.features.empty()) {
-      standPat += nnue_->evaluateMiniQSearch(nnueAccumulator_.features) / 32;
-    }
+  // make/unmake on boardSnapshot_ with the per-ply stacks kept in step.
+  // `ply` is the node the move is played from.
+  bool makeMove(const movegen::Move& move, int ply, board::Undo& undo) {
+    if (!boardSnapshot_.makeMove(move.from, move.to, move.promotion, undo)) return false;
+    if (nnue_ && nnue_->enabled) nnueStack_.push(undo.dirty);
+    materialStack_.push_back(materialStack_.back() + eval::materialPstDelta(undo.dirty, materialParams()));
+    keyStack_.push_back(tt::hash(boardSnapshot_));
+    playedMoves_[static_cast<std::size_t>(ply + 1)] = move;
+    return true;
+  }
 
-    const int originalStandPat = standPat;
-    if (standPat >= beta) return beta;
-    alpha = std::max(alpha, standPat);
+  void unmakeMove(const movegen::Move& move, const board::Undo& undo) {
+    keyStack_.pop_back();
+    materialStack_.pop_back();
+    if (nnue_ && nnue_->enabled) nnueStack_.pop();
+    boardSnapshot_.unmakeMove(move.from, move.to, move.promotion, undo);
+  }
 
-    int best = standPat;
-    const int deltaMargin = 96;
-    const auto legalMoves = movegen::generateLegal(boardSnapshot_);
-    for (const auto& mv : legalMoves) {
-      const bool isCapture = boardSnapshot_.squares[static_cast<std::size_t>(mv.to)] != '.';
-      const bool isPromotion = mv.promotion != '\0';
-      const int seeScore = see_ ? see_->estimate(mv, &boardSnapshot_.squares) : 0;
-      const bool quietCheckLike = !isCapture && !isPromotion && (mv.to % 8 == 4 || mv.to / 8 == 4);
-      if (!isCapture && !isPromotion && !quietCheckLike) continue;
-      if (isCapture && seeScore < -80 && !isPromotion) continue;
-      if (standPat + seeScore + deltaMargin < alpha && !quietCheckLike && !isPromotion) continue;
+  struct NullUndo {
+    int enPassantSquare = -1;
+    int halfmoveClock = 0;
+  };
 
-      int tactical = evaluateMoveLazy(mv, 0, false) / 4 + seeScore / 2;
-      best = std::max(best, standPat + tactical);
-      alpha = std::max(alpha, best);
-      if (alpha >= beta) return beta;
-    }
+  // Passes the move. The halfmove clock restarts so repetition checks stop
+  // at the null move.
+  NullUndo makeNullMove(int ply) {
+    const NullUndo undo{boardSnapshot_.enPassantSquare, boardSnapshot_.halfmoveClock};
+    boardSnapshot_.whiteToMove = !boardSnapshot_.whiteToMove;
+    boardSnapshot_.enPassantSquare = -1;
+    boardSnapshot_.halfmoveClock = 0;
+    if (nnue_ && nnue_->enabled) nnueStack_.push(board::DirtyPieces{});
+    materialStack_.push_back(materialStack_.back());
+    keyStack_.push_back(tt::hash(boardSnapshot_));
+    playedMoves_[static_cast<std::size_t>(ply + 1)] = movegen::Move{};
+    return undo;
+  }
 
-    if (std::abs(best - originalStandPat) > 240) {
-      best = (best + originalStandPat) / 2;  // damp stand-pat instability spikes
-    }
+  void unmakeNullMove(const NullUndo& undo) {
+    keyStack_.pop_back();
+    materialStack_.pop_back();
+    if (nnue_ && nnue_->enabled) nnueStack_.pop();
+    boardSnapshot_.whiteToMove = !boardSnapshot_.whiteToMove;
+    boardSnapshot_.enPassantSquare = undo.enPassantSquare;
+    boardSnapshot_.halfmoveClock = undo.halfmoveClock;
+  }
 
-    if (strategyNet_ && strategyNet_->enabled) {
-      const auto& out = getStrategyOutput(false);
-      const float tacticalPressure = (out.tacticalThreat[0] + out.tacticalThreat[1]);
-      if (tacticalPressure < 0.05f) {
-        best = std::min(best, beta - 2);  // soft quiescence pruning
-      }
+  // Search order at interior nodes: the hash move, captures and promotions
+  // that SEE does not expect to lose, killers, the counter to the previous
+  // move, quiet moves by history, then losing captures.
+  int orderScore(const movegen::Move& m, int ply, const movegen::Move& ttMove, const movegen::Move& counterMove) const {
+    if (m == ttMove) return 1 << 30;
+    const char victim = boardSnapshot_.squares[static_cast<std::size_t>(m.to)];
+    if (victim != '.' || m.promotion != '\0') {
+      const int see = see_ ? see_->estimate(m, boardSnapshot_)
+                           : engine_components::search_helpers::SEE::pieceValue(victim);
+      return see >= 0 ? (1 << 28) + see : -(1 << 20) + see;
+    }
+    if (killer_ && ply < kMaxPly) {
+      const auto& killers = killer_->killer[static_cast<std::size_t>(ply)];
+      if (m == killers[0]) return (1 << 27) + 1;
+      if (m == killers[1]) return 1 << 27;
     }
+    if (m == counterMove) return 1 << 26;
+    return history_ ? history_->score[static_cast<std::size_t>(m.from)][static_cast<std::size_t>(m.to)] : 0;
+  }
 
-    if (strategyNet_ && strategyNet_->enabled) {
-      const auto& out = getStrategyOutput(false);
-      const float tacticalPressure = (out.tacticalThreat[0] + out.tacticalThreat[1]);
-      if (tacticalPressure < 0.05f) {
-        beta -= 2;  // soft quiescence pruning when no tactical pressure is predicted
+  // Quiet move `best` cut off at `ply`: it becomes a killer and the counter
+  // to the previous move, and gains history while the quiet moves tried
+  // before it lose some.
+  void recordCutoff(const movegen::Move& best, int ply, int depth, const movegen::Move* tried, int triedCount) {
+    if (killer_ && ply < kMaxPly) {
+      auto& killers = killer_->killer[static_cast<std::size_t>(ply)];
+      if (killers[0] != best) {
+        killers[1] = killers[0];
+        killers[0] = best;
       }
     }
-
-    return std::clamp(standPat, alpha, beta);
+    const movegen::Move& previous = playedMoves_[static_cast<std::size_t>(ply)];
+    if (counter_ && previous.from >= 0) {
+      counter_->counter[static_cast<std::size_t>(previous.from)][static_cast<std::size_t>(previous.to)] = best;
+    }
+    if (history_) {
+      const int bonus = std::min(depth * depth, 400);
+      auto adjust = [&](const movegen::Move& m, int delta) {
+        int& cell = history_->score[static_cast<std::size_t>(m.from)][static_cast<std::size_t>(m.to)];
+        cell += delta - cell * std::abs(delta) / kHistoryMax;
+      };
+      adjust(best, bonus);
+      for (int i = 0; i < triedCount; ++i) adjust(tried[i], -bonus);
+    }
   }
 
-
+  // Triangular PV: the line at `ply` becomes `move` followed by the line
+  // its child just returned.
+  void updatePv(int ply, const movegen::Move& move) {
+    if (!pvTable_) return;
+    auto& line = pvTable_->pv[static_cast<std::size_t>(ply)];
+    const auto& child = pvTable_->pv[static_cast<std::size_t>(ply + 1)];
+    const int childLength = std::max(pvTable_->length[static_cast<std::size_t>(ply + 1)], ply + 1);
+    line[static_cast<std::size_t>(ply)] = move;
+    for (int i = ply + 1; i < childLength; ++i) line[static_cast<std::size_t>(i)] = child[static_cast<std::size_t>(i)];
+    pvTable_->length[static_cast<std::size_t>(ply)] = childLength;
+  }
 
   engine_components::eval_model::GamePhase detectGamePhase() const {
     int nonPawnMaterial = 0;
@@ -412,23 +849,58 @@ class Searcher {
     return engine_components::eval_model::GamePhase::Endgame;
   }
 
-  engine_components::eval_model::StrategyOutput evaluateStrategyNet() const {
-    std::vector<float> planes(static_cast<std::size_t>(strategyNet_->cfg.planes), 0.0f);
-    for (int sq = 0; sq < 64; ++sq) {
-      const char piece = boardSnapshot_.squares[static_cast<std::size_t>(sq)];
-      if (piece == '.') continue;
-      int idx = std::min(strategyNet_->cfg.planes - 1, std::tolower(static_cast<unsigned char>(piece)) - 'a');
-      if (idx >= 0 && idx < strategyNet_->cfg.planes) planes[static_cast<std::size_t>(idx)] += 1.0f / 8.0f;
-    }
-    return strategyNet_->evaluate(planes, detectGamePhase());
+  std::vector<float> strategyPlanes() const {
+    return engine_components::eval_model::StrategyNet::boardPlanes(boardSnapshot_.squares, strategyNet_->cfg.planes);
+  }
+
+  // Legal moves of boardSnapshot_, whose policy logits a strategy
+  // evaluation computes: rootMoves_ at the root, generated anywhere else,
+  // so a cached record is right for its position whenever it becomes a root.
+  const std::vector<movegen::Move>& strategyMoves() const {
+    if (keyStack_.size() <= 1) return rootMoves_;
+    strategyMoves_ = movegen::generateLegal(boardSnapshot_);
+    return strategyMoves_;
   }
 
-  const engine_components::eval_model::StrategyOutput& getStrategyOutput(bool refresh) const {
+  // Into strategyScratch_, whose policy storage is reused across calls.
+  const engine_components::eval_model::StrategyOutput& evaluateStrategyNet() const {
+    engine_components::eval_model::StrategyQuery query;
+    query.legalMoves = &strategyMoves();
+    strategyNet_->evaluateInto(strategyPlanes(), detectGamePhase(), query, strategyScratch_);
+    return strategyScratch_;
+  }
+
+  // Strategy output for boardSnapshot_ as it stands. Results always go
+  // through a StrategyCache record, so a hit and a fresh evaluation give
+  // the search identical numbers. With a running strategyService_ a miss
+  // below the root is posted to it and the search carries on with neutral
+  // strategy terms. The root, whose policy picks the pruning width before
+  // the first iteration, is evaluated in place, as is everything under
+  // DeterministicMode or when the cache has no room to publish results.
+  const engine_components::eval_model::StrategyOutput& getStrategyOutput() const {
+    using engine_components::eval_model::StrategyCache;
     if (!strategyNet_ || !strategyNet_->enabled) return cachedStrategy_;
-    if (!strategyCached_ || refresh) {
-      cachedStrategy_ = evaluateStrategyNet();
-      strategyCached_ = true;
+    const std::uint64_t key = keyStack_.back();
+    if (strategyCached_ && cachedStrategyKey_ == key) return cachedStrategy_;
+    StrategyCache::Record record;
+    if (strategyCache_ && strategyCache_->probe(key, record)) {
+      ++strategyCacheHits_;
+    } else if (pendingStrategyKey_ == key) {
+      return neutralStrategy_;
+    } else if (keyStack_.size() > 1 && strategyCache_ && strategyCache_->size() > 0 && strategyService_ &&
+               !parallelCfg_.deterministicMode &&
+               strategyService_->post({key, strategyPlanes(), detectGamePhase(), strategyMoves()})) {
+      pendingStrategyKey_ = key;
+      ++strategyPosted_;
+      return neutralStrategy_;
+    } else {
+      record = StrategyCache::encode(evaluateStrategyNet());
+      ++strategyEvaluations_;
+      if (strategyCache_) strategyCache_->store(key, record);
     }
+    cachedStrategy_ = StrategyCache::decode(record);
+    cachedStrategyKey_ = key;
+    strategyCached_ = true;
     return cachedStrategy_;
   }
 
@@ -452,9 +924,8 @@ class Searcher {
       bias += static_cast<int>(policy_->priors[hintIndex] * 100.0f);
     }
     if (strategyNet_ && strategyNet_->enabled) {
-      const auto& out = getStrategyOutput(false);
-      const std::size_t to = static_cast<std::size_t>(m.to % static_cast<int>(out.policy.size()));
-      if (!out.policy.empty()) bias += static_cast<int>(out.policy[to] * 20.0f);
+      const auto& out = getStrategyOutput();
+      bias += static_cast<int>(out.policyLogit(strategyNet_->policyIndex(m)) * 20.0f);
       bias += static_cast<int>((out.tacticalThreat[0] - out.tacticalThreat[1]) * 20.0f);
     }
     return bias;
@@ -468,46 +939,194 @@ class Searcher {
     return static_cast<int>(closedness * depth * 3.0f);
   }
 
-  int evaluateMoveLazy(const movegen::Move& move, int depth, bool useMaster) const {
+  // The strategy network's WDL edge; never more than kWdlWeight either way.
+  static constexpr int kWdlWeight = 40;
+  int strategyWdlBias() const {
+    if (!strategyNet_ || !strategyNet_->enabled) return 0;
+    const auto& out = getStrategyOutput();
+    const float wdlEdge = out.wdl[0] - out.wdl[2];
+    return static_cast<int>(wdlEdge * static_cast<float>(kWdlWeight));
+  }
+
+  // Root ordering terms other than the children's NNUE score.
+  int lazyMoveBias(const movegen::Move& move, int depth, bool useMaster) const {
     int score = moveOrderingBias(move, depth);
     score += static_cast<int>(__builtin_popcountll(temporal_.velocityMask()) / 8);
-    if (nnue_ && nnue_->enabled) {
-      if (useMaster) score += nnue_->evaluateFromAccumulator(nnueAccumulator_) / 24;
-      else score += nnue_->evaluateDraft(nnueAccumulator_.features) / 24;
+    if (useMaster) score += strategyWdlBias();
+    return score;
+  }
+
+  const eval::Params& materialParams() const { return evalParams_ ? *evalParams_ : eval::kTunedParams; }
+
+  // Network score (centipawns, side to move) of `pos`, the position on top
+  // of `stack`, from the cheapest tier that still leaves it outside
+  // [alpha, beta] by more than that tier's calibrated error, and no dearer
+  // than `ceiling`. With useLazyEval off every call is full.
+  int cascadeEval(const board::Board& pos, engine_components::eval_model::NNUE::AccumulatorStack& stack, int alpha,
+                  int beta, engine_components::search_arch::EvalTier ceiling,
+                  engine_components::search_arch::EvalTier& tier) const {
+    using engine_components::search_arch::kTierDraft;
+    using engine_components::search_arch::kTierFull;
+    using engine_components::search_arch::kTierMaterial;
+    auto outside = [&](int score) { return score < alpha ? alpha - score : score > beta ? score - beta : 0; };
+    const int material = pos.whiteToMove ? materialStack_.back() : -materialStack_.back();
+    const bool cascade = features_.useLazyEval;
+    const bool lopsided = features_.cascadeLopsided > 0 && std::abs(material) >= features_.cascadeLopsided;
+    int score = 0;
+    if (cascade && (outside(material) > features_.cascadeMaterialMargin || (lopsided && outside(material) > 0))) {
+      tier = kTierMaterial;
+      score = material;
+    } else {
+      const auto& acc = stack.current(*nnue_, pos);
+      const int draft = cascade ? nnue_->evaluateDraft(acc) : 0;
+      if (cascade && (ceiling == kTierDraft || outside(draft) > features_.cascadeDraftMargin)) {
+        tier = kTierDraft;
+        score = draft;
+      } else {
+        tier = kTierFull;
+        score = nnue_->evaluateFromAccumulator(acc);
+      }
     }
-    if (strategyNet_ && strategyNet_->enabled && useMaster) {
-      const auto& out = getStrategyOutput(false);
-      const float wdlEdge = out.wdl[0] - out.wdl[2];
-      score += static_cast<int>(wdlEdge * 40.0f);
+    ++tierCounts_[static_cast<std::size_t>(tier)];
+    if (cascadeLog_ && ++cascadeCalls_ % kCascadeSampleEvery == 0) {
+      const auto& acc = stack.current(*nnue_, pos);
+      const int full = nnue_->evaluateFromAccumulator(acc);
+      cascadeLog_->record(material, nnue_->evaluateDraft(acc), full);
     }
     return score;
   }
 
-  void updateHeuristics(int ply, const movegen::Move& best) {
-    if (killer_ && ply < static_cast<int>(killer_->killer.size())) {
-      killer_->killer[ply][1] = killer_->killer[ply][0];
-      killer_->killer[ply][0] = best;
-    }
-    if (history_) {
-      for (auto& row : history_->score) for (int& cell : row) cell = (cell * 31) / 32;
-      for (int from = 0; from < 64; ++from) {
-        for (int to = 0; to < 64; ++to) {
-          if (from == best.from && to == best.to) continue;
-          history_->score[from][to] -= std::clamp(history_->score[from][to] / 64, -1, 1);
-        }
+  // Root ordering scores for the first `count` moves: lazyMoveBias() less
+  // each child's full NNUE score, the children's upper layers evaluated as
+  // one batch.
+  std::vector<int> scoutScores(const std::vector<std::pair<int, movegen::Move>>& ordered, std::size_t count,
+                               int depth) {
+    using NNUE = engine_components::eval_model::NNUE;
+    std::vector<int> scores(count);
+    for (std::size_t i = 0; i < count; ++i) scores[i] = lazyMoveBias(ordered[i].second, depth, true);
+    if (!nnue_ || !nnue_->enabled) return scores;
+    std::vector<NNUE::Accumulator> children(count);
+    std::vector<const NNUE::Accumulator*> batch;
+    std::vector<std::size_t> lanes;
+    for (std::size_t i = 0; i < count; ++i) {
+      const movegen::Move& move = ordered[i].second;
+      board::Undo undo;
+      if (!boardSnapshot_.makeMove(move.from, move.to, move.promotion, undo)) {
+        scores[i] = -250000;
+        continue;
       }
-      history_->score[best.from][best.to] += 4;
+      nnueStack_.push(undo.dirty);
+      children[i] = nnueStack_.current(*nnue_, boardSnapshot_);
+      nnueStack_.pop();
+      boardSnapshot_.unmakeMove(move.from, move.to, move.promotion, undo);
+      batch.push_back(&children[i]);
+      lanes.push_back(i);
     }
-    if (counter_ && best.from >= 0 && best.from < 64 && best.to >= 0 && best.to < 64) {
-      counter_->counter[best.from][best.to] = best;
+    std::vector<int> childScores(batch.size());
+    nnue_->evaluateAccumulators(batch.data(), batch.size(), childScores.data());
+    for (std::size_t j = 0; j < lanes.size(); ++j) scores[lanes[j]] -= childScores[j] / 24;
+    return scores;
+  }
+};
+
+// Move-ordering tables one search thread owns.
+struct ThreadTables {
+  engine_components::search_helpers::KillerTable killer;
+  engine_components::search_helpers::HistoryHeuristic history;
+  engine_components::search_helpers::CounterMoveTable counter;
+  engine_components::search_helpers::PVTable pvTable;
+};
+
+// Lazy SMP helpers: persistent threads that each run a job with their own
+// ThreadTables, kept from one search to the next like the main thread's.
+// A job builds a Searcher (with its own board and accumulator stack) over
+// the shared transposition table and searches the same root with its
+// thread index.
+class SearchThreads {
+ public:
+  using Job = std::function<void(int index, ThreadTables& tables)>;
+
+  explicit SearchThreads(int helpers) : tables_(static_cast<std::size_t>(std::max(0, helpers))) {
+    for (int i = 0; i < helpers; ++i) threads_.emplace_back([this, i] { loop(i); });
+  }
+
+  ~SearchThreads() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      quit_ = true;
     }
-    if (pvTable_ && ply < static_cast<int>(pvTable_->length.size())) {
-      pvTable_->pv[ply][0] = best;
-      pvTable_->length[ply] = 1;
+    wake_.notify_all();
+    for (auto& t : threads_) t.join();
+  }
+
+  SearchThreads(const SearchThreads&) = delete;
+  SearchThreads& operator=(const SearchThreads&) = delete;
+
+  int helpers() const { return static_cast<int>(threads_.size()); }
+
+  // Runs job(1..helpers()) on the helpers and returns at once; wait() blocks
+  // until every one has returned. `job` must outlive the wait().
+  void start(const Job& job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job_ = &job;
+      busy_ = helpers();
+      ++generation_;
     }
+    wake_.notify_all();
   }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this] { return busy_ == 0; });
+  }
+
+ private:
+  void loop(int i) {
+    std::uint64_t seen = 0;
+    while (true) {
+      const Job* job = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&] { return quit_ || generation_ != seen; });
+        if (quit_) return;
+        seen = generation_;
+        job = job_;
+      }
+      (*job)(i + 1, tables_[static_cast<std::size_t>(i)]);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --busy_;
+      }
+      finished_.notify_all();
+    }
+  }
+
+  std::vector<ThreadTables> tables_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable finished_;
+  const Job* job_ = nullptr;
+  std::uint64_t generation_ = 0;
+  int busy_ = 0;
+  bool quit_ = false;
 };
 
+// Index of the result to play: the deepest completed iteration, and the
+// higher score between equally deep ones; ties keep the lower index.
+inline std::size_t selectResult(const std::vector<Result>& results) {
+  std::size_t best = 0;
+  for (std::size_t i = 1; i < results.size(); ++i) {
+    const Result& r = results[i];
+    if (r.pv.empty()) continue;
+    if (r.depth > results[best].depth || (r.depth == results[best].depth && r.scoreCp > results[best].scoreCp)) {
+      best = i;
+    }
+  }
+  return best;
+}
+
 }  // namespace search
 
 #endif
@@ -0,0 +1,727 @@
+#include "simd.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+namespace simd {
+namespace {
+
+// mulhi_epu16(c << kFtShift, c << kFtShift) is (c * c) >> (16 - 2 * kFtShift);
+// this shift takes it the rest of the way to squaredClippedRelu().
+constexpr int kSquareShift = (2 * kFtShift + 7) - (16 - 2 * kFtShift);
+static_assert(kSquareShift >= 0 && (kFtMax << kFtShift) <= 0xffff, "SCReLU operands must fit uint16");
+
+void addRowScalar(std::int16_t* acc, const std::int16_t* row, int n) {
+  for (int i = 0; i < n; ++i) acc[i] = static_cast<std::int16_t>(acc[i] + row[i]);
+}
+
+void subRowScalar(std::int16_t* acc, const std::int16_t* row, int n) {
+  for (int i = 0; i < n; ++i) acc[i] = static_cast<std::int16_t>(acc[i] - row[i]);
+}
+
+void clippedReluScalar(const std::int16_t* in, std::uint8_t* out, int n) {
+  for (int i = 0; i < n; ++i) out[i] = clippedRelu(in[i]);
+}
+
+void squaredClippedReluScalar(const std::int16_t* in, std::uint8_t* out, int n) {
+  for (int i = 0; i < n; ++i) out[i] = squaredClippedRelu(in[i]);
+}
+
+std::int32_t dotScalar(const std::uint8_t* in, const std::int8_t* row, int begin, int end) {
+  std::int32_t sum = 0;
+  for (int i = begin; i < end; ++i) sum += static_cast<std::int32_t>(in[i]) * row[i];
+  return sum;
+}
+
+void affineScalar(const std::uint8_t* in, const std::int8_t* w, const std::int32_t* bias, std::int32_t* out,
+                  int inputs, int outputs) {
+  for (int o = 0; o < outputs; ++o) {
+    out[o] = bias[o] + dotScalar(in, w + static_cast<std::size_t>(o) * inputs, 0, inputs);
+  }
+}
+
+// sparseAffine() finds non-zero groups one window at a time, so the index
+// list lives on the stack whatever the layer width.
+constexpr int kSparseWindow = 4096;  // inputs
+
+std::int32_t groupBits(const std::uint8_t* in) {
+  std::int32_t v;
+  std::memcpy(&v, in, sizeof(v));
+  return v;
+}
+
+int nonZeroGroupsScalar(const std::uint8_t* in, int begin, int end, std::uint16_t* groups, int count) {
+  for (int i = begin; i < end; i += kSparseGroup) {
+    if (groupBits(in + i) != 0) groups[count++] = static_cast<std::uint16_t>(i / kSparseGroup);
+  }
+  return count;
+}
+
+// out[o] += the listed groups for outputs [begin, end).
+void sparseOutputsScalar(const std::uint8_t* in, const std::int8_t* w, const std::uint16_t* groups, int count,
+                         std::int32_t* out, int begin, int end, int outputs) {
+  for (int k = 0; k < count; ++k) {
+    const std::uint8_t* x = in + groups[k] * kSparseGroup;
+    const std::int8_t* row = w + static_cast<std::size_t>(groups[k]) * outputs * kSparseGroup;
+    for (int o = begin; o < end; ++o) {
+      const std::int8_t* c = row + o * kSparseGroup;
+      out[o] += x[0] * c[0] + x[1] * c[1] + x[2] * c[2] + x[3] * c[3];
+    }
+  }
+}
+
+void sparseAffineScalar(const std::uint8_t* in, const std::int8_t* w, const std::int32_t* bias, std::int32_t* out,
+                        int inputs, int outputs) {
+  std::uint16_t groups[kSparseWindow / kSparseGroup];
+  std::copy(bias, bias + outputs, out);
+  for (int begin = 0; begin < inputs; begin += kSparseWindow) {
+    const int count = nonZeroGroupsScalar(in, begin, std::min(inputs, begin + kSparseWindow), groups, 0);
+    sparseOutputsScalar(in, w, groups, count, out, 0, outputs, outputs);
+  }
+}
+
+// sparseAffineBatch() runs this many positions against each weight row.
+constexpr int kBatchLanes = 4;
+
+// Groups in [begin, end) that are non-zero in any of `lanes` rows of `in`.
+int nonZeroGroupsBatch(const std::uint8_t* in, int inputs, int lanes, int begin, int end, std::uint16_t* groups) {
+  int count = 0;
+  for (int i = begin; i < end; i += kSparseGroup) {
+    std::int32_t any = 0;
+    for (int l = 0; l < lanes; ++l) any |= groupBits(in + static_cast<std::size_t>(l) * inputs + i);
+    if (any != 0) groups[count++] = static_cast<std::uint16_t>(i / kSparseGroup);
+  }
+  return count;
+}
+
+void sparseAffineBatchScalar(const std::uint8_t* in, const std::int8_t* w, const std::int32_t* bias,
+                             std::int32_t* out, int inputs, int outputs, int n) {
+  for (int l = 0; l < n; ++l) {
+    sparseAffineScalar(in + static_cast<std::size_t>(l) * inputs, w, bias, out + static_cast<std::size_t>(l) * outputs,
+                       inputs, outputs);
+  }
+}
+
+#if SIMD_X86
+
+// ---- SSE4.1 (maddubs is SSSE3) -------------------------------------------
+
+__attribute__((target("ssse3,sse4.1"))) void addRowSse(std::int16_t* acc, const std::int16_t* row, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i* a = reinterpret_cast<__m128i*>(acc + i);
+    _mm_storeu_si128(a, _mm_add_epi16(_mm_loadu_si128(a), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i))));
+  }
+  addRowScalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("ssse3,sse4.1"))) void subRowSse(std::int16_t* acc, const std::int16_t* row, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i* a = reinterpret_cast<__m128i*>(acc + i);
+    _mm_storeu_si128(a, _mm_sub_epi16(_mm_loadu_si128(a), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i))));
+  }
+  subRowScalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("ssse3,sse4.1"))) void clippedReluSse(const std::int16_t* in, std::uint8_t* out, int n) {
+  const __m128i top = _mm_set1_epi8(kActivationMax);
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i a = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), kFtShift);
+    const __m128i b = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8)), kFtShift);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_min_epu8(_mm_packus_epi16(a, b), top));
+  }
+  clippedReluScalar(in + i, out + i, n - i);
+}
+
+// Lambdas do not inherit target attributes, hence the separate helpers.
+__attribute__((target("ssse3,sse4.1"))) inline __m128i squareSse(const std::int16_t* p) {
+  const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  const __m128i c = _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(kFtMax));
+  const __m128i s = _mm_slli_epi16(c, kFtShift);
+  return _mm_srli_epi16(_mm_mulhi_epu16(s, s), kSquareShift);
+}
+
+__attribute__((target("ssse3,sse4.1"))) void squaredClippedReluSse(const std::int16_t* in, std::uint8_t* out,
+                                                                    int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(squareSse(in + i), squareSse(in + i + 8)));
+  }
+  squaredClippedReluScalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("ssse3,sse4.1"))) void affineSse(const std::uint8_t* in, const std::int8_t* w,
+                                                        const std::int32_t* bias, std::int32_t* out, int inputs,
+                                                        int outputs) {
+  const __m128i ones = _mm_set1_epi16(1);
+  const int vecEnd = inputs & ~15;
+  for (int o = 0; o < outputs; ++o) {
+    const std::int8_t* row = w + static_cast<std::size_t>(o) * inputs;
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < vecEnd; i += 16) {
+      const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, y), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    out[o] = bias[o] + _mm_cvtsi128_si32(sum) + dotScalar(in, row, vecEnd, inputs);
+  }
+}
+
+__attribute__((target("ssse3,sse4.1"))) int nonZeroGroupsSse(const std::uint8_t* in, int begin, int end,
+                                                              std::uint16_t* groups) {
+  int count = 0;
+  int i = begin;
+  for (; i + 16 <= end; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    const __m128i zero = _mm_cmpeq_epi32(v, _mm_setzero_si128());
+    for (int mask = _mm_movemask_ps(_mm_castsi128_ps(zero)) ^ 0xf; mask; mask &= mask - 1) {
+      groups[count++] = static_cast<std::uint16_t>(i / kSparseGroup + __builtin_ctz(static_cast<unsigned>(mask)));
+    }
+  }
+  return nonZeroGroupsScalar(in, i, end, groups, count);
+}
+
+// Same scheme as sparseAffineVnni().
+__attribute__((target("ssse3,sse4.1"))) void sparseAffineSse(const std::uint8_t* in, const std::int8_t* w,
+                                                              const std::int32_t* bias, std::int32_t* out, int inputs,
+                                                              int outputs) {
+  const __m128i ones = _mm_set1_epi16(1);
+  std::uint16_t groups[kSparseWindow / kSparseGroup];
+  std::copy(bias, bias + outputs, out);
+  const int vecEnd = outputs & ~3;
+  const std::size_t stride = static_cast<std::size_t>(outputs) * kSparseGroup;
+  for (int begin = 0; begin < inputs; begin += kSparseWindow) {
+    const int count = nonZeroGroupsSse(in, begin, std::min(inputs, begin + kSparseWindow), groups);
+    int k = 0;
+    for (; k + 2 <= count; k += 2) {
+      const __m128i x0 = _mm_set1_epi32(groupBits(in + groups[k] * kSparseGroup));
+      const __m128i x1 = _mm_set1_epi32(groupBits(in + groups[k + 1] * kSparseGroup));
+      const std::int8_t* r0 = w + groups[k] * stride;
+      const std::int8_t* r1 = w + groups[k + 1] * stride;
+      for (int o = 0; o < vecEnd; o += 4) {
+        const __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + o * kSparseGroup));
+        const __m128i y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + o * kSparseGroup));
+        // Two int16 pair sums per output; each stays within 2 * 127 * 127.
+        const __m128i pairs = _mm_add_epi32(_mm_madd_epi16(_mm_maddubs_epi16(x0, y0), ones),
+                                            _mm_madd_epi16(_mm_maddubs_epi16(x1, y1), ones));
+        __m128i* a = reinterpret_cast<__m128i*>(out + o);
+        _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), pairs));
+      }
+    }
+    for (; k < count; ++k) {
+      const __m128i x0 = _mm_set1_epi32(groupBits(in + groups[k] * kSparseGroup));
+      const std::int8_t* r0 = w + groups[k] * stride;
+      for (int o = 0; o < vecEnd; o += 4) {
+        const __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + o * kSparseGroup));
+        __m128i* a = reinterpret_cast<__m128i*>(out + o);
+        _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), _mm_madd_epi16(_mm_maddubs_epi16(x0, y0), ones)));
+      }
+    }
+    sparseOutputsScalar(in, w, groups, count, out, vecEnd, outputs, outputs);
+  }
+}
+
+// Same scheme as sparseAffineBatchAvx2().
+__attribute__((target("ssse3,sse4.1"))) void sparseAffineBatchSse(const std::uint8_t* in, const std::int8_t* w,
+                                                                   const std::int32_t* bias, std::int32_t* out,
+                                                                   int inputs, int outputs, int n) {
+  const __m128i ones = _mm_set1_epi16(1);
+  std::uint16_t groups[kSparseWindow / kSparseGroup];
+  const int vecEnd = outputs & ~3;
+  const std::size_t stride = static_cast<std::size_t>(outputs) * kSparseGroup;
+  int first = 0;
+  for (; first + kBatchLanes <= n; first += kBatchLanes) {
+    const std::uint8_t* x = in + static_cast<std::size_t>(first) * inputs;
+    std::int32_t* y = out + static_cast<std::size_t>(first) * outputs;
+    for (int l = 0; l < kBatchLanes; ++l) std::copy(bias, bias + outputs, y + l * outputs);
+    for (int begin = 0; begin < inputs; begin += kSparseWindow) {
+      const int end = std::min(inputs, begin + kSparseWindow);
+      const int count = nonZeroGroupsBatch(x, inputs, kBatchLanes, begin, end, groups);
+      for (int k = 0; k < count; ++k) {
+        __m128i xs[kBatchLanes];
+        for (int l = 0; l < kBatchLanes; ++l) {
+          xs[l] = _mm_set1_epi32(groupBits(x + l * inputs + groups[k] * kSparseGroup));
+        }
+        const std::int8_t* r = w + groups[k] * stride;
+        for (int o = 0; o < vecEnd; o += 4) {
+          const __m128i wv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r + o * kSparseGroup));
+          for (int l = 0; l < kBatchLanes; ++l) {
+            __m128i* a = reinterpret_cast<__m128i*>(y + l * outputs + o);
+            _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), _mm_madd_epi16(_mm_maddubs_epi16(xs[l], wv), ones)));
+          }
+        }
+      }
+      for (int l = 0; l < kBatchLanes; ++l) {
+        sparseOutputsScalar(x + l * inputs, w, groups, count, y + l * outputs, vecEnd, outputs, outputs);
+      }
+    }
+  }
+  for (; first < n; ++first) {
+    sparseAffineSse(in + static_cast<std::size_t>(first) * inputs, w, bias,
+                    out + static_cast<std::size_t>(first) * outputs, inputs, outputs);
+  }
+}
+
+// ---- AVX2 -----------------------------------------------------------------
+
+__attribute__((target("avx2"))) void addRowAvx2(std::int16_t* acc, const std::int16_t* row, int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i* a = reinterpret_cast<__m256i*>(acc + i);
+    const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+    _mm256_storeu_si256(a, _mm256_add_epi16(_mm256_loadu_si256(a), r));
+  }
+  addRowScalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("avx2"))) void subRowAvx2(std::int16_t* acc, const std::int16_t* row, int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i* a = reinterpret_cast<__m256i*>(acc + i);
+    const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+    _mm256_storeu_si256(a, _mm256_sub_epi16(_mm256_loadu_si256(a), r));
+  }
+  subRowScalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("avx2"))) void clippedReluAvx2(const std::int16_t* in, std::uint8_t* out, int n) {
+  const __m256i top = _mm256_set1_epi8(kActivationMax);
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i a = _mm256_srai_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), kFtShift);
+    const __m256i b = _mm256_srai_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16)), kFtShift);
+    // packus works per 128-bit lane; restore element order before storing.
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_min_epu8(packed, top));
+  }
+  clippedReluScalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline __m256i squareAvx2(const std::int16_t* p) {
+  const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  const __m256i c = _mm256_min_epi16(_mm256_max_epi16(x, _mm256_setzero_si256()), _mm256_set1_epi16(kFtMax));
+  const __m256i s = _mm256_slli_epi16(c, kFtShift);
+  return _mm256_srli_epi16(_mm256_mulhi_epu16(s, s), kSquareShift);
+}
+
+__attribute__((target("avx2"))) void squaredClippedReluAvx2(const std::int16_t* in, std::uint8_t* out, int n) {
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i packed =
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(squareAvx2(in + i), squareAvx2(in + i + 16)), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+  }
+  squaredClippedReluScalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline std::int32_t horizontalSum(__m256i v) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+  return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2"))) void affineAvx2(const std::uint8_t* in, const std::int8_t* w,
+                                                 const std::int32_t* bias, std::int32_t* out, int inputs,
+                                                 int outputs) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  const int vecEnd = inputs & ~31;
+  for (int o = 0; o < outputs; ++o) {
+    const std::int8_t* row = w + static_cast<std::size_t>(o) * inputs;
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < vecEnd; i += 32) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+      const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, y), ones));
+    }
+    out[o] = bias[o] + horizontalSum(sum) + dotScalar(in, row, vecEnd, inputs);
+  }
+}
+
+__attribute__((target("avx2"))) int nonZeroGroupsAvx2(const std::uint8_t* in, int begin, int end,
+                                                       std::uint16_t* groups) {
+  int count = 0;
+  int i = begin;
+  for (; i + 32 <= end; i += 32) {
+    const __m256i zero =
+        _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), _mm256_setzero_si256());
+    for (int mask = _mm256_movemask_ps(_mm256_castsi256_ps(zero)) ^ 0xff; mask; mask &= mask - 1) {
+      groups[count++] = static_cast<std::uint16_t>(i / kSparseGroup + __builtin_ctz(static_cast<unsigned>(mask)));
+    }
+  }
+  return nonZeroGroupsScalar(in, i, end, groups, count);
+}
+
+// Same scheme as sparseAffineVnni().
+__attribute__((target("avx2"))) void sparseAffineAvx2(const std::uint8_t* in, const std::int8_t* w,
+                                                       const std::int32_t* bias, std::int32_t* out, int inputs,
+                                                       int outputs) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  std::uint16_t groups[kSparseWindow / kSparseGroup];
+  std::copy(bias, bias + outputs, out);
+  const int vecEnd = outputs & ~7;
+  const std::size_t stride = static_cast<std::size_t>(outputs) * kSparseGroup;
+  for (int begin = 0; begin < inputs; begin += kSparseWindow) {
+    const int count = nonZeroGroupsAvx2(in, begin, std::min(inputs, begin + kSparseWindow), groups);
+    int k = 0;
+    for (; k + 2 <= count; k += 2) {
+      const __m256i x0 = _mm256_set1_epi32(groupBits(in + groups[k] * kSparseGroup));
+      const __m256i x1 = _mm256_set1_epi32(groupBits(in + groups[k + 1] * kSparseGroup));
+      const std::int8_t* r0 = w + groups[k] * stride;
+      const std::int8_t* r1 = w + groups[k + 1] * stride;
+      for (int o = 0; o < vecEnd; o += 8) {
+        const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r0 + o * kSparseGroup));
+        const __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r1 + o * kSparseGroup));
+        const __m256i pairs = _mm256_add_epi32(_mm256_madd_epi16(_mm256_maddubs_epi16(x0, y0), ones),
+                                               _mm256_madd_epi16(_mm256_maddubs_epi16(x1, y1), ones));
+        __m256i* a = reinterpret_cast<__m256i*>(out + o);
+        _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a), pairs));
+      }
+    }
+    for (; k < count; ++k) {
+      const __m256i x0 = _mm256_set1_epi32(groupBits(in + groups[k] * kSparseGroup));
+      const std::int8_t* r0 = w + groups[k] * stride;
+      for (int o = 0; o < vecEnd; o += 8) {
+        const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r0 + o * kSparseGroup));
+        __m256i* a = reinterpret_cast<__m256i*>(out + o);
+        const __m256i sums = _mm256_madd_epi16(_mm256_maddubs_epi16(x0, y0), ones);
+        _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a), sums));
+      }
+    }
+    sparseOutputsScalar(in, w, groups, count, out, vecEnd, outputs, outputs);
+  }
+}
+
+// sparseAffine() for kBatchLanes positions at a time: each live group's row
+// is streamed across the outputs once per block, every weight vector applied
+// to all lanes, with the block's sums in L1. Sixteen vector registers leave
+// no room to hold the sums in registers as sparseAffineBatchVnni() does.
+__attribute__((target("avx2"))) void sparseAffineBatchAvx2(const std::uint8_t* in, const std::int8_t* w,
+                                                            const std::int32_t* bias, std::int32_t* out, int inputs,
+                                                            int outputs, int n) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  std::uint16_t groups[kSparseWindow / kSparseGroup];
+  const int vecEnd = outputs & ~7;
+  const std::size_t stride = static_cast<std::size_t>(outputs) * kSparseGroup;
+  int first = 0;
+  for (; first + kBatchLanes <= n; first += kBatchLanes) {
+    const std::uint8_t* x = in + static_cast<std::size_t>(first) * inputs;
+    std::int32_t* y = out + static_cast<std::size_t>(first) * outputs;
+    for (int l = 0; l < kBatchLanes; ++l) std::copy(bias, bias + outputs, y + l * outputs);
+    for (int begin = 0; begin < inputs; begin += kSparseWindow) {
+      const int end = std::min(inputs, begin + kSparseWindow);
+      const int count = nonZeroGroupsBatch(x, inputs, kBatchLanes, begin, end, groups);
+      for (int k = 0; k < count; ++k) {
+        __m256i xs[kBatchLanes];
+        for (int l = 0; l < kBatchLanes; ++l) {
+          xs[l] = _mm256_set1_epi32(groupBits(x + l * inputs + groups[k] * kSparseGroup));
+        }
+        const std::int8_t* r = w + groups[k] * stride;
+        for (int o = 0; o < vecEnd; o += 8) {
+          const __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + o * kSparseGroup));
+          for (int l = 0; l < kBatchLanes; ++l) {
+            __m256i* a = reinterpret_cast<__m256i*>(y + l * outputs + o);
+            const __m256i sums = _mm256_madd_epi16(_mm256_maddubs_epi16(xs[l], wv), ones);
+            _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a), sums));
+          }
+        }
+      }
+      for (int l = 0; l < kBatchLanes; ++l) {
+        sparseOutputsScalar(x + l * inputs, w, groups, count, y + l * outputs, vecEnd, outputs, outputs);
+      }
+    }
+  }
+  for (; first < n; ++first) {
+    sparseAffineAvx2(in + static_cast<std::size_t>(first) * inputs, w, bias,
+                     out + static_cast<std::size_t>(first) * outputs, inputs, outputs);
+  }
+}
+
+// ---- AVX-512 VNNI ---------------------------------------------------------
+
+__attribute__((target("avx512f,avx512bw"))) void addRowAvx512(std::int16_t* acc, const std::int16_t* row, int n) {
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    _mm512_storeu_si512(acc + i, _mm512_add_epi16(_mm512_loadu_si512(acc + i), _mm512_loadu_si512(row + i)));
+  }
+  addRowScalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void subRowAvx512(std::int16_t* acc, const std::int16_t* row, int n) {
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    _mm512_storeu_si512(acc + i, _mm512_sub_epi16(_mm512_loadu_si512(acc + i), _mm512_loadu_si512(row + i)));
+  }
+  subRowScalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) void affineVnni(const std::uint8_t* in, const std::int8_t* w,
+                                                                        const std::int32_t* bias, std::int32_t* out,
+                                                                        int inputs, int outputs) {
+  const int vecEnd = inputs & ~63;
+  for (int o = 0; o < outputs; ++o) {
+    const std::int8_t* row = w + static_cast<std::size_t>(o) * inputs;
+    __m512i sum = _mm512_setzero_si512();
+    for (int i = 0; i < vecEnd; i += 64) {
+      const __m512i x = _mm512_loadu_si512(in + i);
+      const __m512i y = _mm512_loadu_si512(row + i);
+      sum = _mm512_dpbusd_epi32(sum, x, y);
+    }
+    // _mm512_reduce_add_epi32 trips -Wmaybe-uninitialized inside GCC's headers.
+    alignas(64) std::int32_t lanes[16];
+    _mm512_store_si512(lanes, sum);
+    std::int32_t total = 0;
+    for (std::int32_t v : lanes) total += v;
+    out[o] = bias[o] + total + dotScalar(in, row, vecEnd, inputs);
+  }
+}
+
+__attribute__((target("avx512f,avx512bw"))) int nonZeroGroupsAvx512(const std::uint8_t* in, int begin, int end,
+                                                                      std::uint16_t* groups) {
+  int count = 0;
+  int i = begin;
+  for (; i + 64 <= end; i += 64) {
+    const __m512i v = _mm512_loadu_si512(in + i);
+    for (unsigned mask = _mm512_test_epi32_mask(v, v); mask; mask &= mask - 1) {
+      groups[count++] = static_cast<std::uint16_t>(i / kSparseGroup + __builtin_ctz(mask));
+    }
+  }
+  return nonZeroGroupsScalar(in, i, end, groups, count);
+}
+
+// Streams each live group's row across every output: the row is one
+// contiguous read and the int32 sums stay in L1. Two groups per pass halve
+// the load/store traffic on the sums.
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) void sparseAffineVnni(const std::uint8_t* in,
+                                                                              const std::int8_t* w,
+                                                                              const std::int32_t* bias,
+                                                                              std::int32_t* out, int inputs,
+                                                                              int outputs) {
+  std::uint16_t groups[kSparseWindow / kSparseGroup];
+  std::copy(bias, bias + outputs, out);
+  const int vecEnd = outputs & ~15;
+  const std::size_t stride = static_cast<std::size_t>(outputs) * kSparseGroup;
+  for (int begin = 0; begin < inputs; begin += kSparseWindow) {
+    const int count = nonZeroGroupsAvx512(in, begin, std::min(inputs, begin + kSparseWindow), groups);
+    int k = 0;
+    for (; k + 2 <= count; k += 2) {
+      const __m512i x0 = _mm512_set1_epi32(groupBits(in + groups[k] * kSparseGroup));
+      const __m512i x1 = _mm512_set1_epi32(groupBits(in + groups[k + 1] * kSparseGroup));
+      const std::int8_t* r0 = w + groups[k] * stride;
+      const std::int8_t* r1 = w + groups[k + 1] * stride;
+      for (int o = 0; o < vecEnd; o += 16) {
+        __m512i a = _mm512_loadu_si512(out + o);
+        a = _mm512_dpbusd_epi32(a, x0, _mm512_loadu_si512(r0 + o * kSparseGroup));
+        a = _mm512_dpbusd_epi32(a, x1, _mm512_loadu_si512(r1 + o * kSparseGroup));
+        _mm512_storeu_si512(out + o, a);
+      }
+    }
+    for (; k < count; ++k) {
+      const __m512i x0 = _mm512_set1_epi32(groupBits(in + groups[k] * kSparseGroup));
+      const std::int8_t* r0 = w + groups[k] * stride;
+      for (int o = 0; o < vecEnd; o += 16) {
+        const __m512i a = _mm512_loadu_si512(out + o);
+        _mm512_storeu_si512(out + o, _mm512_dpbusd_epi32(a, x0, _mm512_loadu_si512(r0 + o * kSparseGroup)));
+      }
+    }
+    sparseOutputsScalar(in, w, groups, count, out, vecEnd, outputs, outputs);
+  }
+}
+
+// bits[l][k] = the four activations of lane l in the listed group k.
+inline void batchGroupBits(const std::uint8_t* in, int inputs, const std::uint16_t* groups, int count,
+                           std::int32_t (*bits)[kSparseWindow / kSparseGroup]) {
+  for (int l = 0; l < kBatchLanes; ++l) {
+    const std::uint8_t* x = in + static_cast<std::size_t>(l) * inputs;
+    for (int k = 0; k < count; ++k) bits[l][k] = groupBits(x + groups[k] * kSparseGroup);
+  }
+}
+
+// kTile vectors of outputs starting at o for every lane of a block: the
+// kBatchLanes x kTile sums stay in registers across all live groups, so each
+// weight vector is loaded once and feeds one dpbusd per lane.
+template <int kTile>
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) inline void batchTileVnni(
+    const std::int32_t (*bits)[kSparseWindow / kSparseGroup], const std::int8_t* w, const std::uint16_t* groups,
+    int count, std::int32_t* y, int o, int outputs) {
+  const std::size_t stride = static_cast<std::size_t>(outputs) * kSparseGroup;
+  __m512i acc[kBatchLanes][kTile];
+  for (int l = 0; l < kBatchLanes; ++l) {
+    for (int t = 0; t < kTile; ++t) acc[l][t] = _mm512_loadu_si512(y + l * outputs + o + t * 16);
+  }
+  for (int k = 0; k < count; ++k) {
+    const std::int8_t* r = w + groups[k] * stride + o * kSparseGroup;
+    __m512i wv[kTile];
+    for (int t = 0; t < kTile; ++t) wv[t] = _mm512_loadu_si512(r + t * 64);
+    for (int l = 0; l < kBatchLanes; ++l) {
+      const __m512i x = _mm512_set1_epi32(bits[l][k]);
+      for (int t = 0; t < kTile; ++t) acc[l][t] = _mm512_dpbusd_epi32(acc[l][t], x, wv[t]);
+    }
+  }
+  for (int l = 0; l < kBatchLanes; ++l) {
+    for (int t = 0; t < kTile; ++t) _mm512_storeu_si512(y + l * outputs + o + t * 16, acc[l][t]);
+  }
+}
+
+// sparseAffine() for kBatchLanes positions at a time, as a register-blocked
+// matrix product over the groups live in any of them: every weight vector
+// is loaded once per block instead of once per position, and lanes whose
+// group is zero add nothing. Leftover positions take the one-position path.
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) void sparseAffineBatchVnni(const std::uint8_t* in,
+                                                                                   const std::int8_t* w,
+                                                                                   const std::int32_t* bias,
+                                                                                   std::int32_t* out, int inputs,
+                                                                                   int outputs, int n) {
+  std::uint16_t groups[kSparseWindow / kSparseGroup];
+  std::int32_t bits[kBatchLanes][kSparseWindow / kSparseGroup];
+  const int vecEnd = outputs & ~15;
+  const int tileEnd = outputs & ~63;
+  int first = 0;
+  for (; first + kBatchLanes <= n; first += kBatchLanes) {
+    const std::uint8_t* x = in + static_cast<std::size_t>(first) * inputs;
+    std::int32_t* y = out + static_cast<std::size_t>(first) * outputs;
+    for (int l = 0; l < kBatchLanes; ++l) std::copy(bias, bias + outputs, y + l * outputs);
+    for (int begin = 0; begin < inputs; begin += kSparseWindow) {
+      const int end = std::min(inputs, begin + kSparseWindow);
+      const int count = nonZeroGroupsBatch(x, inputs, kBatchLanes, begin, end, groups);
+      batchGroupBits(x, inputs, groups, count, bits);
+      int o = 0;
+      for (; o < tileEnd; o += 64) batchTileVnni<4>(bits, w, groups, count, y, o, outputs);
+      for (; o < vecEnd; o += 16) batchTileVnni<1>(bits, w, groups, count, y, o, outputs);
+      for (int l = 0; l < kBatchLanes; ++l) {
+        sparseOutputsScalar(x + l * inputs, w, groups, count, y + l * outputs, vecEnd, outputs, outputs);
+      }
+    }
+  }
+  for (; first < n; ++first) {
+    sparseAffineVnni(in + static_cast<std::size_t>(first) * inputs, w, bias,
+                     out + static_cast<std::size_t>(first) * outputs, inputs, outputs);
+  }
+}
+
+#endif  // SIMD_X86
+
+const Kernels kTables[] = {
+    {Level::Scalar, addRowScalar, subRowScalar, clippedReluScalar, squaredClippedReluScalar, affineScalar,
+     sparseAffineScalar, sparseAffineBatchScalar},
+#if SIMD_X86
+    {Level::SSE41, addRowSse, subRowSse, clippedReluSse, squaredClippedReluSse, affineSse, sparseAffineSse,
+     sparseAffineBatchSse},
+    {Level::AVX2, addRowAvx2, subRowAvx2, clippedReluAvx2, squaredClippedReluAvx2, affineAvx2, sparseAffineAvx2,
+     sparseAffineBatchAvx2},
+    // Activations are memory bound; the AVX2 versions are as fast here.
+    {Level::AVX512VNNI, addRowAvx512, subRowAvx512, clippedReluAvx2, squaredClippedReluAvx2, affineVnni,
+     sparseAffineVnni, sparseAffineBatchVnni},
+#endif
+};
+
+bool supported(Level level) {
+  if (level == Level::Scalar) return true;
+#if SIMD_X86
+  __builtin_cpu_init();
+  switch (level) {
+    case Level::SSE41: return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+    case Level::AVX2: return __builtin_cpu_supports("avx2");
+    case Level::AVX512VNNI:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni");
+    default: return false;
+  }
+#else
+  return false;
+#endif
+}
+
+const Kernels& table(Level level) {
+  for (const auto& k : kTables) {
+    if (k.level == level) return k;
+  }
+  return kTables[0];
+}
+
+std::atomic<const Kernels*>& active() {
+  static std::atomic<const Kernels*> current{&table(detect())};
+  return current;
+}
+
+}  // namespace
+
+const char* name(Level level) {
+  switch (level) {
+    case Level::SSE41: return "sse4.1";
+    case Level::AVX2: return "avx2";
+    case Level::AVX512VNNI: return "avx512vnni";
+    default: return "scalar";
+  }
+}
+
+bool parseLevel(const std::string& text, Level& level) {
+  for (Level l : {Level::Scalar, Level::SSE41, Level::AVX2, Level::AVX512VNNI}) {
+    if (text == name(l)) {
+      level = l;
+      return true;
+    }
+  }
+  return false;
+}
+
+Level detect() {
+  for (Level l : {Level::AVX512VNNI, Level::AVX2, Level::SSE41}) {
+    if (supported(l)) return l;
+  }
+  return Level::Scalar;
+}
+
+const Kernels& kernels() { return *active().load(std::memory_order_relaxed); }
+
+void* ScratchArena::allocateBytes(std::size_t bytes) {
+  constexpr std::size_t kMinBlock = 64 * 1024;
+  bytes = (bytes + AlignedAllocator<unsigned char>::kAlignment - 1) & ~(AlignedAllocator<unsigned char>::kAlignment - 1);
+  for (;;) {
+    if (block_ == blocks_.size()) blocks_.emplace_back(std::max(kMinBlock, bytes));
+    auto& block = blocks_[block_];
+    if (used_ + bytes <= block.size()) {
+      void* p = block.data() + used_;
+      used_ += bytes;
+      return p;
+    }
+    if (used_ == 0) {
+      // Nothing in this block or after it is live: replace it with one big
+      // enough, so the arena converges on few blocks.
+      block = AlignedVector<unsigned char>(std::max(bytes, 2 * block.size()));
+      continue;
+    }
+    ++block_;
+    used_ = 0;
+  }
+}
+
+std::size_t ScratchArena::capacity() const {
+  std::size_t total = 0;
+  for (const auto& block : blocks_) total += block.size();
+  return total;
+}
+
+ScratchArena& scratch() {
+  thread_local ScratchArena arena;
+  return arena;
+}
+
+bool select(Level level) {
+  if (!supported(level)) return false;
+  active().store(&table(level), std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace simd
@@ -0,0 +1,139 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace simd {
+
+// Integer ranges shared by every kernel. Feature-transformer values are int16
+// with 1.0 == kFtMax; activations are uint8 with 1.0 == kActivationMax, which
+// keeps uint8 x int8 pair sums (2 * 127 * 127) inside int16 for maddubs.
+constexpr int kActivationMax = 127;
+constexpr int kFtShift = 3;
+constexpr int kFtMax = kActivationMax << kFtShift;
+
+enum class Level { Scalar, SSE41, AVX2, AVX512VNNI };
+
+// Cache-line aligned storage for weights and accumulators, so vector loads
+// never straddle a line.
+template <typename T>
+struct AlignedAllocator {
+  using value_type = T;
+  static constexpr std::size_t kAlignment = 64;
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U>&) {}
+
+  T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(kAlignment))); }
+  void deallocate(T* p, std::size_t) { ::operator delete(p, std::align_val_t(kAlignment)); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U>&) const { return true; }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// Bump allocator for forward-pass temporaries. Allocations are cache-line
+// aligned and carved from blocks that grow to the high-water mark once and
+// are reused afterwards; a Frame releases everything allocated inside it.
+class ScratchArena {
+ public:
+  class Frame {
+   public:
+    explicit Frame(ScratchArena& arena) : arena_(arena), block_(arena.block_), used_(arena.used_) {}
+    ~Frame() {
+      arena_.block_ = block_;
+      arena_.used_ = used_;
+    }
+    Frame(const Frame&) = delete;
+    Frame& operator=(const Frame&) = delete;
+
+   private:
+    ScratchArena& arena_;
+    std::size_t block_;
+    std::size_t used_;
+  };
+
+  // n default-initialised (for scalars: indeterminate) elements.
+  template <typename T>
+  T* allocate(std::size_t n) {
+    static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without destructors");
+    T* p = static_cast<T*>(allocateBytes(n * sizeof(T)));
+    for (std::size_t i = 0; i < n; ++i) new (p + i) T;
+    return p;
+  }
+
+  std::size_t capacity() const;
+
+ private:
+  void* allocateBytes(std::size_t bytes);
+
+  std::vector<AlignedVector<unsigned char>> blocks_;
+  std::size_t block_ = 0;
+  std::size_t used_ = 0;
+};
+
+// The calling thread's arena.
+ScratchArena& scratch();
+
+// Scalar definitions every vector kernel must reproduce bit for bit.
+inline std::uint8_t clippedRelu(std::int16_t x) {
+  return static_cast<std::uint8_t>(std::clamp(x >> kFtShift, 0, kActivationMax));
+}
+inline std::uint8_t squaredClippedRelu(std::int16_t x) {
+  const int c = std::clamp<int>(x, 0, kFtMax);
+  return static_cast<std::uint8_t>((c * c) >> (2 * kFtShift + 7));
+}
+
+// Weight order for Kernels::sparseAffine: inputs in groups of kSparseGroup,
+// and each group's weights for every output form one contiguous row, so a
+// group whose activations are all zero is skipped without touching memory.
+constexpr int kSparseGroup = 4;
+inline std::size_t sparseIndex(int o, int i, int outputs) {
+  return (static_cast<std::size_t>(i / kSparseGroup) * outputs + o) * kSparseGroup + i % kSparseGroup;
+}
+
+struct Kernels {
+  Level level = Level::Scalar;
+  // acc[i] += row[i] / acc[i] -= row[i] for i < n, wrapping like int16.
+  void (*addRow)(std::int16_t* acc, const std::int16_t* row, int n);
+  void (*subRow)(std::int16_t* acc, const std::int16_t* row, int n);
+  // out[i] = clippedRelu(in[i]) / squaredClippedRelu(in[i]) for i < n.
+  void (*clippedRelu)(const std::int16_t* in, std::uint8_t* out, int n);
+  void (*squaredClippedRelu)(const std::int16_t* in, std::uint8_t* out, int n);
+  // out[o] = bias[o] + sum_i in[i] * w[o * inputs + i] for o < outputs.
+  void (*affine)(const std::uint8_t* in, const std::int8_t* w, const std::int32_t* bias, std::int32_t* out,
+                 int inputs, int outputs);
+  // The same sums with w in sparseIndex() order, visiting only the input
+  // groups with a non-zero activation. inputs is a multiple of kSparseGroup.
+  void (*sparseAffine)(const std::uint8_t* in, const std::int8_t* w, const std::int32_t* bias, std::int32_t* out,
+                       int inputs, int outputs);
+  // sparseAffine() for n positions: in holds n rows of inputs, out n rows of
+  // outputs. Each weight row is read once per block of positions.
+  void (*sparseAffineBatch)(const std::uint8_t* in, const std::int8_t* w, const std::int32_t* bias,
+                            std::int32_t* out, int inputs, int outputs, int n);
+};
+
+const char* name(Level level);
+bool parseLevel(const std::string& text, Level& level);
+// Best level the running CPU supports, from CPUID.
+Level detect();
+// Active kernel table; the first call selects detect().
+const Kernels& kernels();
+// Forces a level (benchmarks, cross-checks). Fails if the CPU lacks it.
+// Not synchronised with running evaluations: call between searches.
+bool select(Level level);
+
+}  // namespace simd
+
+#endif
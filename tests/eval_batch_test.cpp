@@ -0,0 +1,60 @@
+// Scores a fixed set of positions through evaluateBatch() and evaluate()
+// and fails on any lane where the two disagree, under the tuned weights and
+// under a copy with every weight changed so that none cancels out.
+
+#include <cstdio>
+#include <vector>
+
+#include "eval.h"
+#include "movegen.h"
+
+int main() {
+  const char* const fens[] = {
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+      "2kr3r/ppp2ppp/2n5/2b5/8/2N5/PPP2PPP/R1B2RK1 b - - 0 14",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      "8/8/4k3/3p4/3P4/4K3/8/8 b - - 0 50",
+      "4k3/8/8/8/8/8/PPP5/4K2R w K - 0 1",
+      "6k1/5ppp/8/8/8/8/1B3PPP/1B4K1 w - - 0 30",
+      "r4rk1/1b3ppp/pq2p3/1p6/3N4/1P3QP1/P4P1P/R4RK1 b - - 3 21",
+  };
+
+  std::vector<board::Board> positions;
+  for (const char* fen : fens) {
+    board::Board b;
+    if (!b.setFromFEN(fen)) {
+      std::printf("eval_batch_test bad fen %s\n", fen);
+      return 1;
+    }
+    positions.push_back(b);
+    // A few plies on from each, picked by a fixed stride through the moves.
+    for (int ply = 0; ply < 6; ++ply) {
+      const auto legal = movegen::generateLegal(b);
+      if (legal.empty()) break;
+      const auto& mv = legal[static_cast<std::size_t>(ply * 5 + 3) % legal.size()];
+      b.applyMove(mv.from, mv.to, mv.promotion);
+      positions.push_back(b);
+    }
+  }
+
+  eval::Params shifted = eval::kTunedParams;
+  for (int i = 0; i < eval::kParamCount; ++i) eval::setParam(shifted, i, eval::param(shifted, i) + 3 + i);
+
+  int mismatches = 0;
+  std::vector<int> batched(positions.size());
+  for (const eval::Params& params : {eval::kTunedParams, shifted}) {
+    eval::evaluateBatch(positions.data(), positions.size(), params, batched.data());
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      const int single = eval::evaluate(positions[i], params);
+      if (batched[i] == single) continue;
+      ++mismatches;
+      std::printf("eval_batch_test mismatch position=%zu single=%d batch=%d\n", i, single, batched[i]);
+    }
+  }
+
+  std::printf("eval_batch_test positions=%zu mismatches=%d\n", positions.size(), mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
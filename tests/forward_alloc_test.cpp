@@ -0,0 +1,106 @@
+// Counts heap allocations made by the NNUE and StrategyNet forward passes
+// once their scratch arena and outputs have grown to size; any is a failure.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "engine_components.h"
+
+namespace {
+std::atomic<long> allocations{0};
+
+void* countedAlloc(std::size_t bytes, std::size_t alignment) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes = std::max<std::size_t>(bytes, 1);
+  void* p = alignment > alignof(std::max_align_t)
+                ? std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment)
+                : std::malloc(bytes);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+}  // namespace
+
+void* operator new(std::size_t bytes) { return countedAlloc(bytes, 0); }
+void* operator new[](std::size_t bytes) { return countedAlloc(bytes, 0); }
+void* operator new(std::size_t bytes, std::align_val_t a) { return countedAlloc(bytes, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t bytes, std::align_val_t a) { return countedAlloc(bytes, static_cast<std::size_t>(a)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+int main() {
+  using engine_components::eval_model::GamePhase;
+  using engine_components::eval_model::NNUE;
+  using engine_components::eval_model::StrategyJob;
+  using engine_components::eval_model::StrategyNet;
+  using engine_components::eval_model::StrategyOutput;
+  using engine_components::eval_model::StrategyQuery;
+
+  // Missing files give the synthetic weights.
+  NNUE nnue;
+  nnue.load("");
+  StrategyNet strategy;
+  strategy.load("");
+
+  std::vector<board::Board> positions;
+  board::Board b;
+  b.setStartPos();
+  for (int ply = 0; ply < 8; ++ply) {
+    positions.push_back(b);
+    const auto legal = movegen::generateLegal(b);
+    b.applyMove(legal[static_cast<std::size_t>(ply * 7) % legal.size()].from,
+                legal[static_cast<std::size_t>(ply * 7) % legal.size()].to,
+                legal[static_cast<std::size_t>(ply * 7) % legal.size()].promotion);
+  }
+
+  std::vector<NNUE::FeatureList> features;
+  std::vector<NNUE::Accumulator> accs(positions.size());
+  std::vector<const NNUE::Accumulator*> accPtrs;
+  std::vector<std::vector<float>> planes;
+  std::vector<std::vector<movegen::Move>> legalMoves;
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    features.push_back(NNUE::extractFeatures(positions[i].squares, positions[i].whiteToMove, nnue.cfg.inputs));
+    nnue.initializeAccumulator(accs[i], features[i]);
+    accPtrs.push_back(&accs[i]);
+    planes.push_back(StrategyNet::boardPlanes(positions[i].squares, strategy.cfg.planes));
+    legalMoves.push_back(movegen::generateLegal(positions[i]));
+  }
+  std::vector<StrategyJob> jobs;
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    StrategyQuery query;
+    query.legalMoves = &legalMoves[i];
+    jobs.push_back({&planes[i], GamePhase::Middlegame, query});
+  }
+  std::vector<StrategyOutput> outs(positions.size());
+  StrategyOutput dense;
+  std::vector<int> scores(positions.size());
+
+  long checksum = 0;
+  auto forwardPasses = [&] {
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+      checksum += nnue.evaluateFromAccumulator(accs[i]) + nnue.evaluateDraft(accs[i]) + nnue.evaluate(features[i]);
+    }
+    nnue.evaluateAccumulators(accPtrs.data(), accPtrs.size(), scores.data());
+    strategy.evaluateBatch(jobs.data(), jobs.size(), outs.data());
+    strategy.evaluateInto(planes[0], GamePhase::Opening, StrategyQuery{}, dense);
+    strategy.evaluateInto(planes[1], GamePhase::Endgame, jobs[1].query, outs[1]);
+    checksum += scores[0] + outs[0].valueCp + dense.valueCp;
+  };
+
+  forwardPasses();
+  const long before = allocations.load();
+  for (int r = 0; r < 4; ++r) forwardPasses();
+  const long counted = allocations.load() - before;
+
+  std::printf("forward_alloc_test allocations=%ld arena_bytes=%zu checksum=%ld\n", counted,
+              simd::scratch().capacity(), checksum);
+  return counted == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Searches with the StrategyService running and fails unless the search
+// reads back StrategyNet results. A search left with neutral strategy terms
+// throughout passes every other check, so nothing else would notice.
+
+#include <atomic>
+#include <cstdio>
+
+#include "engine_components.h"
+#include "search.h"
+
+namespace {
+
+search::Result think(const board::Board& b, int depth, engine_components::eval_model::StrategyNet& strategy,
+                     engine_components::eval_model::NNUE& nnue,
+                     engine_components::eval_model::StrategyCache& cache,
+                     engine_components::eval_model::StrategyService& service) {
+  engine_components::search_arch::Features features;
+  features.usePolicyPruning = true;
+  features.policyTopK = strategy.cfg.topKForPruning;
+  features.policyPruneThreshold = strategy.cfg.pruneThreshold;
+  features.useLazyEval = true;
+  search::ThreadTables tables;
+  engine_components::search_helpers::SEE see;
+  const engine_components::eval_model::PolicyNet policy;
+  tt::Table table;
+  table.initialize(16);
+  search::Searcher searcher(features, &tables.killer, &tables.history, &tables.counter, &tables.pvTable, &see, nullptr,
+                            &eval::kTunedParams, &policy, &nnue, &strategy, {}, {}, &table, &cache, &service);
+  search::Limits limits;
+  limits.depth = depth;
+  const std::atomic<bool> stop{false};
+  return searcher.think(b, limits, &stop);
+}
+
+}  // namespace
+
+int main() {
+  using engine_components::eval_model::NNUE;
+  using engine_components::eval_model::StrategyCache;
+  using engine_components::eval_model::StrategyNet;
+  using engine_components::eval_model::StrategyService;
+
+  tt::initializeZobrist();
+  // Missing files give the synthetic weights.
+  NNUE nnue;
+  nnue.load("");
+  StrategyNet strategy;
+  strategy.load("");
+
+  // 1.e4 e5 2.Nf3 Nc6
+  board::Board b;
+  b.setFromFEN("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+
+  StrategyCache cache;
+  cache.initialize(4);
+  StrategyService service(strategy, cache);
+  service.start();
+  const search::Result async = think(b, 6, strategy, nnue, cache, service);
+
+  // A cache with no entries cannot publish anything, so misses are
+  // evaluated in place rather than posted.
+  StrategyCache none;
+  none.initialize(0);
+  StrategyService unpublished(strategy, none);
+  unpublished.start();
+  const search::Result noCache = think(b, 4, strategy, nnue, none, unpublished);
+
+  std::printf("strategy_async_test async_posted=%d async_hits=%d async_evals=%d nocache_posted=%d nocache_evals=%d\n",
+              async.strategyPosted, async.strategyCacheHits, async.strategyEvaluations, noCache.strategyPosted,
+              noCache.strategyEvaluations);
+  const bool ok = async.strategyPosted > 0 && async.strategyCacheHits > 0 && noCache.strategyPosted == 0 &&
+                  noCache.strategyEvaluations > 0;
+  return ok ? 0 : 1;
+}
@@ -10,7 +10,6 @@ std::array<std::array<std::uint64_t, 64>, 12> zPieces{};
 std::array<std::uint64_t, 16> zCastle{};
 std::array<std::uint64_t, 8> zEp{};
 std::uint64_t zSide = 0;
-bool initialized = false;
 
 int pieceIndex(char p) {
   switch (p) {
@@ -31,16 +30,19 @@ int pieceIndex(char p) {
 }
 }  // namespace
 
+// Search threads hash concurrently; the keys are filled exactly once.
 void initializeZobrist() {
-  if (initialized) return;
-  std::mt19937_64 rng(0xC0D3A5ULL);
-  for (auto& piece : zPieces) {
-    for (auto& sq : piece) sq = rng();
-  }
-  for (auto& x : zCastle) x = rng();
-  for (auto& x : zEp) x = rng();
-  zSide = rng();
-  initialized = true;
+  static const bool filled = [] {
+    std::mt19937_64 rng(0xC0D3A5ULL);
+    for (auto& piece : zPieces) {
+      for (auto& sq : piece) sq = rng();
+    }
+    for (auto& x : zCastle) x = rng();
+    for (auto& x : zEp) x = rng();
+    zSide = rng();
+    return true;
+  }();
+  (void)filled;
 }
 
 std::uint64_t hash(const board::Board& b) {
@@ -1,11 +1,13 @@
 #ifndef TT_H
 #define TT_H
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
 #include "board.h"
+#include "movegen.h"
 
 namespace tt {
 
@@ -17,42 +19,110 @@ struct Entry {
   int score = 0;
   Bound bound = Bound::Exact;
   std::uint8_t generation = 0;
+  movegen::Move move;  // best or refuting move; from < 0 when there is none
 };
 
+// Shared by every search thread without locks. A slot is two relaxed
+// atomic words, the packed entry and the key XORed with it, so a slot torn
+// by concurrent stores fails the key check and reads as a miss.
 struct Table {
-  std::vector<Entry> entries;
   std::uint8_t generation = 0;
 
   void initialize(std::size_t mb) {
     std::size_t bytes = mb * 1024ULL * 1024ULL;
-    std::size_t count = bytes / sizeof(Entry);
+    std::size_t count = bytes / sizeof(Slot);
     if (count == 0) count = 1;
-    entries.assign(count, Entry{});
+    slots = std::vector<Slot>(count);
   }
 
-  void clear() { entries.assign(entries.size(), Entry{}); }
+  void clear() {
+    for (auto& slot : slots) {
+      slot.check.store(0, std::memory_order_relaxed);
+      slot.data.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::size_t size() const { return slots.size(); }
 
+  // Call between searches only.
   void nextGeneration() { ++generation; }
 
   bool probe(std::uint64_t key, Entry& out) const {
-    if (entries.empty()) return false;
-    const Entry& e = entries[static_cast<std::size_t>(key % entries.size())];
-    if (e.key != key || e.depth < 0) return false;
-    out = e;
+    if (slots.empty()) return false;
+    const Slot& slot = slots[static_cast<std::size_t>(key % slots.size())];
+    const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.check.load(std::memory_order_relaxed) ^ data) != key || data == 0) return false;
+    out = unpack(key, data);
     return true;
   }
 
-  void store(std::uint64_t key, int depth, int score, Bound bound) {
-    if (entries.empty()) return;
-    Entry& slot = entries[static_cast<std::size_t>(key % entries.size())];
-    const bool replace = (slot.key != key) || (depth >= slot.depth) || (slot.generation != generation);
+  // A store without a move keeps the one already held for the same key.
+  void store(std::uint64_t key, int depth, int score, Bound bound, const movegen::Move& move = {}) {
+    if (slots.empty()) return;
+    Slot& slot = slots[static_cast<std::size_t>(key % slots.size())];
+    const std::uint64_t old = slot.data.load(std::memory_order_relaxed);
+    const bool sameKey = (slot.check.load(std::memory_order_relaxed) ^ old) == key && old != 0;
+    const Entry held = unpack(key, old);
+    const bool replace = !sameKey || (depth >= held.depth) || (held.generation != generation);
     if (!replace) return;
-    slot.key = key;
-    slot.depth = depth;
-    slot.score = score;
-    slot.bound = bound;
-    slot.generation = generation;
+    Entry e;
+    e.depth = depth;
+    e.score = score;
+    e.bound = bound;
+    e.generation = generation;
+    e.move = (move.from >= 0 || !sameKey) ? move : held.move;
+    const std::uint64_t data = pack(e);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<std::uint64_t> check{0};
+    std::atomic<std::uint64_t> data{0};
+  };
+
+  // score:16 | depth + 1:8 | bound:2 | generation:8 (bits 32-39) |
+  // move:16 (bits 48-63: from:6, to:6, promotion:3, present:1). Depth + 1
+  // is never 0, so an all-zero word is an empty slot.
+  static std::uint64_t pack(const Entry& e) {
+    std::uint64_t move = 0;
+    if (e.move.from >= 0) {
+      move = static_cast<std::uint64_t>(e.move.from) | static_cast<std::uint64_t>(e.move.to) << 6 |
+             static_cast<std::uint64_t>(promotionCode(e.move.promotion)) << 12 | 1ULL << 15;
+    }
+    return static_cast<std::uint64_t>(static_cast<std::uint16_t>(e.score)) |
+           static_cast<std::uint64_t>(static_cast<std::uint8_t>(e.depth + 1)) << 16 |
+           static_cast<std::uint64_t>(e.bound) << 24 | static_cast<std::uint64_t>(e.generation) << 32 | move << 48;
   }
+
+  static Entry unpack(std::uint64_t key, std::uint64_t data) {
+    Entry e;
+    e.key = key;
+    e.score = static_cast<std::int16_t>(data & 0xFFFF);
+    e.depth = static_cast<int>((data >> 16) & 0xFF) - 1;
+    e.bound = static_cast<Bound>((data >> 24) & 0x3);
+    e.generation = static_cast<std::uint8_t>(data >> 32);
+    const std::uint64_t move = data >> 48;
+    if (move & (1ULL << 15)) {
+      e.move.from = static_cast<int>(move & 63);
+      e.move.to = static_cast<int>((move >> 6) & 63);
+      e.move.promotion = "\0nbrq"[(move >> 12) & 7];
+    }
+    return e;
+  }
+
+  static int promotionCode(char promotion) {
+    switch (promotion) {
+      case 'n': return 1;
+      case 'b': return 2;
+      case 'r': return 3;
+      case 'q': return 4;
+      default: return 0;
+    }
+  }
+
+  std::vector<Slot> slots;
 };
 
 void initializeZobrist();
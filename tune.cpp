@@ -0,0 +1,316 @@
+#include "tune.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+#include "movegen.h"
+
+namespace tune {
+
+namespace {
+
+constexpr double kLn10Over400 = 2.302585092994046 / 400.0;
+constexpr std::size_t kLoadChunk = 1 << 16;
+
+int resolveThreads(int requested) {
+  if (requested > 0) return requested;
+  const unsigned hw = std::thread::hardware_concurrency();
+  return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+// Splits [0, n) into `threads` contiguous ranges and runs fn(begin, end, t) on
+// each; callers reduce per-thread partials in t order so results do not
+// depend on scheduling.
+template <class Fn>
+void parallelFor(int threads, std::size_t n, Fn&& fn) {
+  threads = std::max(1, std::min<int>(threads, static_cast<int>(std::max<std::size_t>(1, n))));
+  if (threads == 1) {
+    fn(std::size_t{0}, n, 0);
+    return;
+  }
+  std::vector<std::thread> pool;
+  pool.reserve(static_cast<std::size_t>(threads));
+  const std::size_t per = (n + static_cast<std::size_t>(threads) - 1) / static_cast<std::size_t>(threads);
+  for (int t = 0; t < threads; ++t) {
+    const std::size_t begin = std::min(n, per * static_cast<std::size_t>(t));
+    const std::size_t end = std::min(n, begin + per);
+    pool.emplace_back([&fn, begin, end, t]() { fn(begin, end, t); });
+  }
+  for (auto& th : pool) th.join();
+}
+
+int pieceValue(char c) {
+  switch (std::tolower(static_cast<unsigned char>(c))) {
+    case 'p': return 100;
+    case 'n': return 320;
+    case 'b': return 330;
+    case 'r': return 500;
+    case 'q': return 900;
+    default: return 0;
+  }
+}
+
+int quiesce(board::Board& b, const eval::Params& params, int alpha, int beta, int plies, board::Board& leaf) {
+  const int standPat = eval::evaluate(b, params);
+  leaf = b;
+  if (standPat >= beta) return standPat;
+  alpha = std::max(alpha, standPat);
+  if (plies <= 0) return alpha;
+
+  std::vector<std::pair<int, movegen::Move>> captures;
+  for (const auto& m : movegen::generatePseudoLegal(b)) {
+    const char mover = b.squares[static_cast<std::size_t>(m.from)];
+    const bool enPassant = m.to == b.enPassantSquare && std::tolower(static_cast<unsigned char>(mover)) == 'p' && m.from % 8 != m.to % 8;
+    const bool capture = b.squares[static_cast<std::size_t>(m.to)] != '.' || enPassant;
+    if (!capture && !m.promotion) continue;
+    const int victim = b.squares[static_cast<std::size_t>(m.to)] != '.' ? pieceValue(b.squares[static_cast<std::size_t>(m.to)]) : 100;
+    captures.push_back({victim * 16 - pieceValue(mover) / 100, m});
+  }
+  std::sort(captures.begin(), captures.end(), [](const auto& l, const auto& r) { return l.first > r.first; });
+
+  board::Board childLeaf;
+  for (const auto& [order, m] : captures) {
+    (void)order;
+    board::Undo u;
+    if (!b.makeMove(m.from, m.to, m.promotion, u)) continue;
+    const int score = -quiesce(b, params, -beta, -alpha, plies - 1, childLeaf);
+    b.unmakeMove(m.from, m.to, m.promotion, u);
+    if (score > alpha) {
+      alpha = score;
+      leaf = childLeaf;
+      if (alpha >= beta) break;
+    }
+  }
+  return alpha;
+}
+
+bool toSample(const board::Board& quiet, int result, Sample& out) {
+  eval::Trace trace;
+  eval::trace(quiet, eval::kTunedParams, trace);
+  for (int i = 0; i < eval::kParamCount; ++i) {
+    const int c = trace.coeff[static_cast<std::size_t>(i)];
+    if (c < std::numeric_limits<std::int8_t>::min() || c > std::numeric_limits<std::int8_t>::max()) return false;
+    out.coeff[static_cast<std::size_t>(i)] = static_cast<std::int8_t>(c);
+  }
+  out.psqt = static_cast<std::int16_t>(trace.psqt);
+  out.result = static_cast<std::uint8_t>(result);
+  return true;
+}
+
+double whiteScore(const Sample& s, const std::array<double, eval::kParamCount>& weights) {
+  double score = s.psqt;
+  for (int i = 0; i < eval::kParamCount; ++i) score += s.coeff[static_cast<std::size_t>(i)] * weights[static_cast<std::size_t>(i)];
+  return score;
+}
+
+double sigmoid(double score, double k) { return 1.0 / (1.0 + std::exp(-k * kLn10Over400 * score)); }
+
+// Sum over the positional weights only; its spread is what lazyMargin must cover.
+bool isPositional(int idx) {
+  return idx == eval::kIsolatedPawn || idx == eval::kDoubledPawn || idx == eval::kBackwardPawn ||
+         idx == eval::kKingSafetyMask || idx == eval::kEndgameKingActivity || idx == eval::kOpeningMobility;
+}
+
+int calibrateMargin(const Dataset& data, const eval::Params& params) {
+  std::vector<int> magnitudes;
+  magnitudes.reserve(data.samples.size());
+  for (const auto& s : data.samples) {
+    int positional = 0;
+    for (int i = 0; i < eval::kParamCount; ++i) {
+      if (isPositional(i)) positional += s.coeff[static_cast<std::size_t>(i)] * eval::param(params, i);
+    }
+    magnitudes.push_back(std::abs(positional));
+  }
+  return eval::lazyMarginPercentile(magnitudes, params.lazyMargin);
+}
+
+double fitK(const Dataset& data, const std::array<double, eval::kParamCount>& weights, int threads) {
+  double best = 1.0;
+  double bestLoss = loss(data, weights, best, threads);
+  double step = 0.5;
+  for (int round = 0; round < 4; ++round) {
+    const double center = best;
+    for (int i = -5; i <= 5; ++i) {
+      const double k = center + i * step;
+      if (k <= 0.0) continue;
+      const double l = loss(data, weights, k, threads);
+      if (l < bestLoss) {
+        bestLoss = l;
+        best = k;
+      }
+    }
+    step /= 10.0;
+  }
+  return best;
+}
+
+long long elapsedMs(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+}  // namespace
+
+bool parseLabelledLine(const std::string& line, board::Board& b, int& result) {
+  std::istringstream iss(line);
+  std::string placement, side, castling, ep;
+  if (!(iss >> placement >> side >> castling >> ep)) return false;
+  if (std::count(placement.begin(), placement.end(), 'K') != 1 || std::count(placement.begin(), placement.end(), 'k') != 1) return false;
+  std::string rest;
+  std::getline(iss, rest);
+
+  std::string counters = "0 1";
+  {
+    std::istringstream cs(rest);
+    std::string half, full;
+    auto numeric = [](const std::string& t) {
+      return std::all_of(t.begin(), t.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+    };
+    if (cs >> half >> full && numeric(half) && numeric(full)) {
+      counters = half + ' ' + full;
+    }
+  }
+
+  if (rest.find("1/2-1/2") != std::string::npos || rest.find("[0.5]") != std::string::npos) result = 1;
+  else if (rest.find("1-0") != std::string::npos || rest.find("[1.0]") != std::string::npos || rest.find("[1]") != std::string::npos) result = 2;
+  else if (rest.find("0-1") != std::string::npos || rest.find("[0.0]") != std::string::npos || rest.find("[0]") != std::string::npos) result = 0;
+  else return false;
+
+  return b.setFromFEN(placement + ' ' + side + ' ' + castling + ' ' + ep + ' ' + counters);
+}
+
+board::Board resolveQuiet(const board::Board& b, const eval::Params& params, int maxPlies) {
+  board::Board work = b;
+  board::Board leaf = b;
+  quiesce(work, params, -1000000, 1000000, maxPlies, leaf);
+  return leaf;
+}
+
+bool load(const std::string& path, const eval::Params& params, int threads, int qsearchPlies, Dataset& out) {
+  std::ifstream in(path);
+  if (!in) return false;
+  threads = resolveThreads(threads);
+  out.samples.clear();
+  out.skipped = 0;
+
+  std::vector<std::string> lines;
+  lines.reserve(kLoadChunk);
+  std::vector<std::vector<Sample>> partial(static_cast<std::size_t>(threads));
+  std::vector<std::size_t> skipped(static_cast<std::size_t>(threads), 0);
+  std::string line;
+  bool more = true;
+  while (more) {
+    lines.clear();
+    while (lines.size() < kLoadChunk && (more = static_cast<bool>(std::getline(in, line)))) {
+      if (!line.empty()) lines.push_back(line);
+    }
+    parallelFor(threads, lines.size(), [&](std::size_t begin, std::size_t end, int t) {
+      auto& samples = partial[static_cast<std::size_t>(t)];
+      board::Board b;
+      int result = 1;
+      Sample s;
+      for (std::size_t i = begin; i < end; ++i) {
+        if (!parseLabelledLine(lines[i], b, result) || !toSample(resolveQuiet(b, params, qsearchPlies), result, s)) {
+          ++skipped[static_cast<std::size_t>(t)];
+          continue;
+        }
+        samples.push_back(s);
+      }
+    });
+    for (auto& samples : partial) {
+      out.samples.insert(out.samples.end(), samples.begin(), samples.end());
+      samples.clear();
+    }
+  }
+  for (std::size_t s : skipped) out.skipped += s;
+  out.samples.shrink_to_fit();
+  return true;
+}
+
+double loss(const Dataset& data, const std::array<double, eval::kParamCount>& weights, double k, int threads) {
+  if (data.samples.empty()) return 0.0;
+  threads = resolveThreads(threads);
+  std::vector<double> partial(static_cast<std::size_t>(threads), 0.0);
+  parallelFor(threads, data.samples.size(), [&](std::size_t begin, std::size_t end, int t) {
+    double sum = 0.0;
+    for (std::size_t i = begin; i < end; ++i) {
+      const Sample& s = data.samples[i];
+      const double err = s.result * 0.5 - sigmoid(whiteScore(s, weights), k);
+      sum += err * err;
+    }
+    partial[static_cast<std::size_t>(t)] = sum;
+  });
+  double total = 0.0;
+  for (double p : partial) total += p;
+  return total / static_cast<double>(data.samples.size());
+}
+
+Report run(const Options& opts, eval::Params& params) {
+  Report report;
+  const int threads = resolveThreads(opts.threads);
+  const auto loadStart = std::chrono::steady_clock::now();
+  Dataset data;
+  if (!load(opts.dataPath, params, threads, opts.qsearchPlies, data)) return report;
+  report.loadMs = elapsedMs(loadStart);
+  report.positions = data.samples.size();
+  report.skipped = data.skipped;
+  if (data.samples.empty()) return report;
+
+  const auto tuneStart = std::chrono::steady_clock::now();
+  std::array<double, eval::kParamCount> weights{};
+  for (int i = 0; i < eval::kParamCount; ++i) weights[static_cast<std::size_t>(i)] = eval::param(params, i);
+  report.k = fitK(data, weights, threads);
+  report.initialLoss = loss(data, weights, report.k, threads);
+
+  // Adam on the mean squared error; every weight has a closed-form gradient
+  // because the score is linear in it.
+  constexpr double kBeta1 = 0.9;
+  constexpr double kBeta2 = 0.999;
+  constexpr double kEps = 1e-8;
+  std::array<double, eval::kParamCount> m{};
+  std::array<double, eval::kParamCount> v{};
+  std::vector<std::array<double, eval::kParamCount>> partial(static_cast<std::size_t>(threads));
+  const double scale = report.k * kLn10Over400;
+  for (int iter = 1; iter <= opts.iterations; ++iter) {
+    parallelFor(threads, data.samples.size(), [&](std::size_t begin, std::size_t end, int t) {
+      auto& grad = partial[static_cast<std::size_t>(t)];
+      grad.fill(0.0);
+      for (std::size_t i = begin; i < end; ++i) {
+        const Sample& s = data.samples[i];
+        const double p = sigmoid(whiteScore(s, weights), report.k);
+        const double term = (s.result * 0.5 - p) * p * (1.0 - p);
+        for (int j = 0; j < eval::kParamCount; ++j) grad[static_cast<std::size_t>(j)] += term * s.coeff[static_cast<std::size_t>(j)];
+      }
+    });
+    std::array<double, eval::kParamCount> grad{};
+    for (const auto& g : partial) {
+      for (int j = 0; j < eval::kParamCount; ++j) grad[static_cast<std::size_t>(j)] += g[static_cast<std::size_t>(j)];
+    }
+    const double norm = -2.0 * scale / static_cast<double>(data.samples.size());
+    const double c1 = 1.0 - std::pow(kBeta1, iter);
+    const double c2 = 1.0 - std::pow(kBeta2, iter);
+    for (int j = 0; j < eval::kParamCount; ++j) {
+      const std::size_t idx = static_cast<std::size_t>(j);
+      const double g = grad[idx] * norm;
+      m[idx] = kBeta1 * m[idx] + (1.0 - kBeta1) * g;
+      v[idx] = kBeta2 * v[idx] + (1.0 - kBeta2) * g * g;
+      weights[idx] -= opts.learningRate * (m[idx] / c1) / (std::sqrt(v[idx] / c2) + kEps);
+    }
+  }
+
+  report.finalLoss = loss(data, weights, report.k, threads);
+  for (int i = 0; i < eval::kParamCount; ++i) {
+    eval::setParam(params, i, static_cast<int>(std::lround(weights[static_cast<std::size_t>(i)])));
+  }
+  params.lazyMargin = calibrateMargin(data, params);
+  report.tuneMs = elapsedMs(tuneStart);
+  report.saved = eval::saveParams(opts.outPath, params);
+  return report;
+}
+
+}  // namespace tune
@@ -0,0 +1,62 @@
+#ifndef TUNE_H
+#define TUNE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "eval.h"
+
+namespace tune {
+
+// One quiescence-resolved position reduced to what the linear evaluation
+// needs: the coefficient of every weight, the untuned PST sum and the game
+// result, all from white's point of view. 20 bytes per position.
+struct Sample {
+  std::array<std::int8_t, eval::kParamCount> coeff{};
+  std::int16_t psqt = 0;
+  std::uint8_t result = 1;  // 0 = black won, 1 = draw, 2 = white won
+};
+
+struct Dataset {
+  std::vector<Sample> samples;
+  std::size_t skipped = 0;
+};
+
+struct Options {
+  std::string dataPath;
+  std::string outPath = "eval_params.txt";
+  int iterations = 400;
+  int threads = 0;  // 0 = std::thread::hardware_concurrency()
+  double learningRate = 1.0;
+  int qsearchPlies = 8;
+};
+
+struct Report {
+  std::size_t positions = 0;
+  std::size_t skipped = 0;
+  double k = 0.0;
+  double initialLoss = 0.0;
+  double finalLoss = 0.0;
+  long long loadMs = 0;
+  long long tuneMs = 0;
+  bool saved = false;
+};
+
+// Accepts EPD/FEN lines labelled with `1-0`, `0-1`, `1/2-1/2` or `[1.0]`,
+// `[0.5]`, `[0.0]` anywhere after the position; the move counters are optional.
+bool parseLabelledLine(const std::string& line, board::Board& b, int& result);
+// Follows the capture-only quiescence PV from `b` and returns its quiet leaf.
+board::Board resolveQuiet(const board::Board& b, const eval::Params& params, int maxPlies);
+bool load(const std::string& path, const eval::Params& params, int threads, int qsearchPlies, Dataset& out);
+double loss(const Dataset& data, const std::array<double, eval::kParamCount>& weights, double k, int threads);
+// Loads opts.dataPath, fits the sigmoid scale, runs Adam over every weight and
+// writes opts.outPath. `params` receives the rounded result.
+Report run(const Options& opts, eval::Params& params);
+
+}  // namespace tune
+
+#endif